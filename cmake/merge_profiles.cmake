@@ -0,0 +1,9 @@
+# Merges Clang's raw PGO profiles in DIR into DIR/default.profdata.
+file(GLOB raw "${DIR}/*.profraw")
+if(NOT raw)
+    message(FATAL_ERROR "No .profraw files in ${DIR}; run the training first")
+endif()
+execute_process(COMMAND ${PROFDATA} merge -output=${DIR}/default.profdata ${raw} RESULT_VARIABLE rc)
+if(NOT rc EQUAL 0)
+    message(FATAL_ERROR "llvm-profdata merge failed")
+endif()
@@ -22,6 +22,11 @@ sim = boid_engine.Simulation(BOID_COUNT, float(WIDTH), float(HEIGHT))
 COLOR_HEAD = np.array([0, 220, 255], dtype=np.uint8)
 COLOR_TAIL = np.array([0, 100, 150], dtype=np.uint8)
 
+# Render buffers filled in place by the engine; sliced as boids are eaten
+head_buf = np.empty((BOID_COUNT, 2), dtype=np.int32)
+body_buf = np.empty((BOID_COUNT, 2), dtype=np.int32)
+tail_buf = np.empty((BOID_COUNT, 2), dtype=np.int32)
+
 # AI Predator state
 class AIPredator:
     def __init__(self):
@@ -126,14 +131,16 @@ while running:
         if event.type == pygame.QUIT: 
             running = False
 
+    # Eaten boids keep their rows until the engine compacts, so hunt live ones only
     state = sim.get_full_state()
-    boid_positions = state[:, :2]
+    alive_idx = np.flatnonzero(sim.alive_mask())
+    boid_positions = state[alive_idx, :2]
     
     boids_to_eat = predator.hunt(boid_positions)
     
     # Remove eaten boids from the simulation
     if len(boids_to_eat) > 0:
-        sim.remove_boids(boids_to_eat)
+        sim.remove_boids(alive_idx[boids_to_eat].tolist())
     
     predator_pos = boid_engine.Vector2D(float(predator.pos[0]), float(predator.pos[1]))
     
@@ -146,18 +153,16 @@ while running:
         clock.tick(60)
         continue
 
-    state = sim.get_full_state()
-    pos = state[:, :2]
-    vel = state[:, 2:]
+    # Boids get eaten, so use the leading rows of the render buffers (views, no copies)
+    row_count = sim.get_full_state().shape[0]
+    head_pos = head_buf[:row_count]
+    body_pos = body_buf[:row_count]
+    tail_pos = tail_buf[:row_count]
+    current_boid_count = sim.alive_count
 
-    v_mag = np.linalg.norm(vel, axis=1, keepdims=True)
-    v_mag = np.maximum(v_mag, 1.0)  # Avoid division by zero (faster than boolean indexing)
-    dir_vec = vel / v_mag
-    
-    # Calculate fish positions
-    head_pos = (pos + dir_vec * 2).astype(np.int32)
-    tail_pos = (pos - dir_vec * 3).astype(np.int32)
-    body_pos = pos.astype(np.int32)
+    # Head/body/tail pixel coordinates straight from the engine, one pass.
+    # Eaten but not yet compacted boids come back as -1 and are masked out below
+    sim.render_geometry(head_pos, body_pos, tail_pos)
 
     # Clear screen
     screen.fill((15, 15, 20))
@@ -191,7 +196,6 @@ while running:
     pygame.draw.line(screen, (255, 150, 150), (predator_x, predator_y), end_pos, 2)
     
     # Update display
-    current_boid_count = len(sim.boids)
     pygame.display.set_caption(
         f"Boids: {current_boid_count} | Eaten: {predator.boids_eaten} | FPS: {int(clock.get_fps())} | AI Predator"
     )
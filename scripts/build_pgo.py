@@ -0,0 +1,94 @@
+"""
+Build boid_engine with profile-guided and link-time optimization.
+
+1. build in place with instrumentation (BOID_ENGINE_PGO=generate)
+2. run the training scenario below against that build
+3. rebuild in place from the profiles (BOID_ENGINE_PGO=use), plus LTO
+
+Profiles are keyed by object path, so every phase builds from this
+checkout. With --wheel a wheel is then built into dist/ from the same
+profiles.
+
+    python scripts/build_pgo.py [--no-lto] [--wheel]
+"""
+import glob
+import math
+import os
+import shutil
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PGO_DIR = os.path.join(ROOT, 'build', 'pgo')
+
+
+def train():
+    """The GUI's workload: moving predator, render buffers, some churn"""
+    import numpy as np
+    import boid_engine
+
+    WIDTH, HEIGHT = 1200.0, 800.0
+    for boid_count, steps in ((5000, 1000), (20000, 200)):
+        sim = boid_engine.Simulation(boid_count, WIDTH, HEIGHT)
+        head = np.empty((boid_count + 1000, 2), dtype=np.int32)
+        body = np.empty_like(head)
+        tail = np.empty_like(head)
+        t0 = time.perf_counter()
+        for s in range(steps):
+            a = s * 0.02
+            sim.step(boid_engine.Vector2D(WIDTH / 2 + 250 * math.cos(a), HEIGHT / 2 + 250 * math.sin(a)))
+            sim.render_geometry(head, body, tail)
+            sim.get_full_state()
+            if s % 100 == 99:
+                n = sim.alive_count
+                sim.remove_boids(np.random.randint(0, n, 50).tolist())
+                sim.add_boids(np.random.rand(50, 2).astype(np.float32) * [WIDTH, HEIGHT])
+        ms = (time.perf_counter() - t0) * 1000 / steps
+        print(f"  trained {boid_count} boids x {steps} steps ({ms:.2f} ms/step)")
+
+
+def build(phase, lto, wheel=False):
+    env = dict(os.environ, BOID_ENGINE_PGO=phase, BOID_ENGINE_PGO_DIR=PGO_DIR,
+               BOID_ENGINE_LTO='1' if lto else '0')
+    if wheel:
+        cmd = [sys.executable, '-m', 'pip', 'wheel', '.', '--no-deps', '--no-build-isolation', '-w', 'dist']
+    else:
+        cmd = [sys.executable, 'setup.py', 'build_ext', '--inplace', '--force']
+    subprocess.run(cmd, cwd=ROOT, env=env, check=True)
+
+
+def merge_clang_profiles():
+    """Clang writes .profraw files; -fprofile-use=DIR reads DIR/default.profdata"""
+    raw = glob.glob(os.path.join(PGO_DIR, '*.profraw'))
+    if not raw:
+        return
+    profdata = shutil.which('llvm-profdata')
+    if not profdata:
+        sys.exit("Clang profiles found but llvm-profdata is not on PATH")
+    subprocess.run([profdata, 'merge', '-output=' + os.path.join(PGO_DIR, 'default.profdata')] + raw,
+                   check=True)
+
+
+def main():
+    if '--train' in sys.argv:
+        sys.path.insert(0, ROOT)
+        train()
+        return
+    lto = '--no-lto' not in sys.argv
+
+    shutil.rmtree(PGO_DIR, ignore_errors=True)
+    os.makedirs(PGO_DIR)
+    print("== instrumented build")
+    build('generate', lto)
+    print("== training run")
+    subprocess.run([sys.executable, os.path.abspath(__file__), '--train'], cwd=ROOT, check=True)
+    merge_clang_profiles()
+    print("== optimized build")
+    build('use', lto)
+    if '--wheel' in sys.argv:
+        build('use', lto, wheel=True)
+
+
+if __name__ == "__main__":
+    main()
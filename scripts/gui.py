@@ -9,8 +9,8 @@ WIDTH, HEIGHT = 1200, 800
 BOID_COUNT = 1000
 
 # Performance settings
-RENDER_EVERY_N_FRAMES = 1  # Set to 2 or 3 to reduce rendering load
-PHYSICS_STEPS_PER_RENDER = 1  # Increase to prioritize simulation over visuals
+PHYSICS_HZ = 60  # Fixed step rate, paced by the engine
+RENDER_EVERY_N_STEPS = 1  # Set to 2 or 3 to reduce rendering load
 
 pygame.init()
 screen = pygame.display.set_mode((WIDTH, HEIGHT))
@@ -22,49 +22,31 @@ sim = boid_engine.Simulation(BOID_COUNT, float(WIDTH), float(HEIGHT))
 COLOR_HEAD = np.array([0, 220, 255], dtype=np.uint8)
 COLOR_TAIL = np.array([0, 100, 150], dtype=np.uint8)
 
-running = True
-frame_count = 0
+# Render buffers filled in place by the engine every frame
+head_pos = np.empty((BOID_COUNT, 2), dtype=np.int32)
+body_pos = np.empty((BOID_COUNT, 2), dtype=np.int32)
+tail_pos = np.empty((BOID_COUNT, 2), dtype=np.int32)
 
 mx, my = -1000.0, -1000.0
 mouse_started = False
 
-while running:
+
+def render():
+    """Called by the engine between steps; returning False stops the run"""
+    global mx, my, mouse_started
     for event in pygame.event.get():
-        if event.type == pygame.QUIT: 
-            running = False
+        if event.type == pygame.QUIT:
+            return False
 
         elif event.type == pygame.MOUSEMOTION:
             mouse_started = True
             mx, my = event.pos
 
-    # Get mouse position once
-    predator_pos = boid_engine.Vector2D(float(mx), float(my))
-    
-    # Run physics (potentially multiple steps)
-    for _ in range(PHYSICS_STEPS_PER_RENDER):
-        sim.step(predator_pos)
-    
-    frame_count += 1
-    
-    # Skip rendering on some frames to reduce CPU load
-    if frame_count % RENDER_EVERY_N_FRAMES != 0:
-        clock.tick(60)
-        continue
-
-    # Extract state only when rendering
-    state = sim.get_full_state()
-    pos = state[:, :2]
-    vel = state[:, 2:]
-
-    # Vectorized direction calculation
-    v_mag = np.linalg.norm(vel, axis=1, keepdims=True)
-    v_mag = np.maximum(v_mag, 1.0)  # Avoid division by zero (faster than boolean indexing)
-    dir_vec = vel / v_mag
-    
-    # Calculate fish positions
-    head_pos = (pos + dir_vec * 2).astype(np.int32)
-    tail_pos = (pos - dir_vec * 3).astype(np.int32)
-    body_pos = pos.astype(np.int32)
+    # Picked up by the following steps
+    sim.predator = boid_engine.Vector2D(float(mx), float(my))
+
+    # Head/body/tail pixel coordinates straight from the engine, one pass
+    sim.render_geometry(head_pos, body_pos, tail_pos)
 
     # Clear screen
     screen.fill((15, 15, 20))
@@ -90,9 +72,14 @@ while running:
     if mouse_started:
         pygame.draw.circle(screen, (255, 50, 50), (mx, my), 15, 1)
     
-    # Update display
+    # Update display; tick() without a rate only measures, it never waits
+    clock.tick()
     pygame.display.set_caption(f"Boids: {BOID_COUNT} | FPS: {int(clock.get_fps())}")
     pygame.display.flip()
-    clock.tick(60)
+    return True
+
+
+# The engine sleeps between steps itself, so there is no busy-wait here
+sim.run_realtime(PHYSICS_HZ, RENDER_EVERY_N_STEPS, render)
 
-pygame.quit()
\ No newline at end of file
+pygame.quit()
@@ -0,0 +1,100 @@
+"""
+Minimal client for the engine's live stream (Simulation.start_stream_server).
+
+Usage:
+    python scripts/stream_client.py unix:/tmp/boids.sock [every] [x0 y0 x1 y1]
+    python scripts/stream_client.py tcp:9000 4
+
+Prints one line per received frame. Use read_frames() from a dashboard to
+get decoded positions as NumPy arrays.
+"""
+import socket
+import struct
+import sys
+import numpy as np
+
+HEADER = struct.Struct('<IIQIB3xff')
+MAGIC = 0x4D524642
+KIND_KEY, KIND_DELTA, KIND_VIEWPORT = 0, 1, 2
+
+
+def connect(address, every=1, viewport=(0.0, 0.0, 0.0, 0.0)):
+    """Connect and subscribe; viewport (x0, y0, x1, y1) of zeros = whole world"""
+    if address.startswith('unix:'):
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        sock.connect(address[5:])
+    elif address.startswith('tcp:'):
+        sock = socket.create_connection(('127.0.0.1', int(address[4:])))
+    else:
+        raise ValueError("address must be unix:/path or tcp:port")
+    sock.sendall(struct.pack('<c3xI4f', b'S', every, *viewport))
+    return sock
+
+
+def recv_exact(sock, n):
+    buf = bytearray(n)
+    view = memoryview(buf)
+    got = 0
+    while got < n:
+        r = sock.recv_into(view[got:])
+        if r == 0:
+            raise ConnectionError("server closed the stream")
+        got += r
+    return buf
+
+
+def decode_varints(payload, count):
+    """Zigzag varints -> int32 array (vectorised over the whole payload)"""
+    data = np.frombuffer(payload, dtype=np.uint8)
+    ends = np.flatnonzero(data < 0x80)
+    starts = np.concatenate(([0], ends[:-1] + 1))
+    values = np.zeros(len(ends), dtype=np.uint32)
+    for shift in range(3):  # int16 deltas need at most 3 bytes
+        idx = starts + shift
+        valid = idx <= ends
+        values[valid] |= (data[idx[valid]].astype(np.uint32) & 0x7F) << (7 * shift)
+    values = values[:count * 2]
+    return (values >> 1).astype(np.int32) ^ -(values & 1).astype(np.int32)
+
+
+def read_frames(sock):
+    """Yield (step, indices or None, positions float32 (n, 2)) per frame"""
+    quantised = None
+    while True:
+        magic, size, step, count, kind, width, height = HEADER.unpack(recv_exact(sock, HEADER.size))
+        if magic != MAGIC:
+            raise ValueError("bad frame header")
+        payload = recv_exact(sock, size)
+        scale = np.array([width, height], dtype=np.float32) / 65535.0
+
+        if kind == KIND_VIEWPORT:
+            rec = np.frombuffer(payload, dtype=[('i', '<u4'), ('x', '<u2'), ('y', '<u2')])
+            pos = np.stack([rec['x'], rec['y']], axis=1).astype(np.float32) * scale
+            yield step, rec['i'], pos
+            continue
+
+        if kind == KIND_KEY:
+            quantised = np.frombuffer(payload, dtype='<u2').astype(np.uint16).reshape(count, 2)
+        elif quantised is not None:
+            deltas = decode_varints(payload, count).reshape(count, 2)
+            quantised = (quantised.astype(np.int32) + deltas).astype(np.uint16)
+        else:
+            continue  # delta before any keyframe; wait for the next key
+        yield step, None, quantised.astype(np.float32) * scale
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+    every = int(sys.argv[2]) if len(sys.argv) > 2 else 1
+    viewport = tuple(float(v) for v in sys.argv[3:7]) if len(sys.argv) >= 7 else (0.0,) * 4
+
+    sock = connect(sys.argv[1], every, viewport)
+    for step, indices, pos in read_frames(sock):
+        print(f"step {step}: {len(pos)} boids, first at {pos[0] if len(pos) else None}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
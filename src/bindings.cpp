@@ -3,12 +3,104 @@
 #include "Boid.h"
 #include "Vector2D.h"
 #include "simulation.h"
+#include "ArrowExport.h"
+#include "DLPack.h"
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
+#include <pybind11/functional.h>
 
 namespace py = pybind11;
 
+// The analyses below size their outputs with row_count() and then run
+// without the GIL; a step on another thread that adds or compacts boids
+// in between makes them fail with this instead of overrunning the output.
+static const char* ROWS_CHANGED = "the number of boids changed during the call; retry";
+
+// Validate a caller-provided output array: it must already have the right
+// dtype, be C-contiguous and writable, since writing into a converted copy
+// would silently lose the results.
+template <typename T>
+static T* out_buffer(py::array& a, py::ssize_t minSize, const char* name) {
+    if (!a.dtype().is(py::dtype::of<T>()))
+        throw std::invalid_argument(std::string(name) + " has the wrong dtype");
+    if (!(a.flags() & py::array::c_style) || !a.writeable())
+        throw std::invalid_argument(std::string(name) + " must be a writable C-contiguous array");
+    if (a.size() < minSize)
+        throw std::invalid_argument(std::string(name) + " is too small");
+    return static_cast<T*>(a.mutable_data());
+}
+
+// PyCapsule destructors for the Arrow PyCapsule interface: a consumer that
+// imported the struct has already moved it out (release == NULL).
+static void release_arrow_schema(PyObject* cap) {
+    ArrowSchema* s = static_cast<ArrowSchema*>(PyCapsule_GetPointer(cap, "arrow_schema"));
+    if (s->release) s->release(s);
+    delete s;
+}
+
+static void release_arrow_array(PyObject* cap) {
+    ArrowArray* a = static_cast<ArrowArray*>(PyCapsule_GetPointer(cap, "arrow_array"));
+    if (a->release) a->release(a);
+    delete a;
+}
+
+static void release_arrow_stream(PyObject* cap) {
+    ArrowArrayStream* st = static_cast<ArrowArrayStream*>(PyCapsule_GetPointer(cap, "arrow_array_stream"));
+    if (st->release) st->release(st);
+    delete st;
+}
+
+static py::object arrow_schema_capsule() {
+    ArrowSchema* s = new ArrowSchema;
+    exportBoidSchema(s);
+    return py::reinterpret_steal<py::object>(PyCapsule_New(s, "arrow_schema", &release_arrow_schema));
+}
+
+// DLPack: the tensor holds a reference to the Simulation that owns the
+// memory; consumers may call the deleter from any thread.
+static void release_dlpack_tensor(DLManagedTensor* t) {
+    DLBoidTensor* bt = static_cast<DLBoidTensor*>(t->manager_ctx);
+    {
+        py::gil_scoped_acquire gil;
+        Py_XDECREF(static_cast<PyObject*>(bt->owner));
+    }
+    delete bt;
+}
+
+static void release_dlpack_capsule(PyObject* cap) {
+    // Renamed to "used_dltensor" once a consumer has taken ownership
+    if (!PyCapsule_IsValid(cap, "dltensor")) return;
+    DLManagedTensor* t = static_cast<DLManagedTensor*>(PyCapsule_GetPointer(cap, "dltensor"));
+    if (t->deleter) t->deleter(t);
+}
+
+// SpawnSpec.min_distance: finite and >= 0 (0 picks the default spacing;
+// tiny values are raised to a floor in poissonPositions)
+// Base object of a SharedStateReader.latest() view: keeps the reader alive
+// and counted in its views until the array is gone.
+struct ReaderView {
+    SharedStateReader* reader;
+    PyObject* owner;
+};
+
+static py::capsule reader_view_owner(py::object selfObj, SharedStateReader& self) {
+    ReaderView* v = new ReaderView{ &self, selfObj.ptr() };
+    Py_INCREF(v->owner);
+    ++self.views;
+    return py::capsule(v, [](void* p) {
+        ReaderView* v = static_cast<ReaderView*>(p);
+        --v->reader->views;
+        Py_DECREF(v->owner);
+        delete v;
+    });
+}
+
+static float check_min_distance(float d) {
+    if (!(d >= 0.0f) || !std::isfinite(d)) throw std::invalid_argument("min_distance must be finite and >= 0");
+    return d;
+}
+
 PYBIND11_MODULE(boid_engine, m) {
     py::class_<Vector2D>(m, "Vector2D")
         .def(py::init<float, float>())
@@ -19,6 +111,61 @@ PYBIND11_MODULE(boid_engine, m) {
         .def("__mul__", &Vector2D::operator*)
         .def("mag", &Vector2D::mag);
 
+    // Many points at once; converts to/from (n, 2) float32 NumPy arrays
+    // without copying (np.asarray(arr) is a view; it dangles if the array
+    // is appended to). Anything taking (n, 2) point arrays accepts it.
+    py::class_<Vector2DArray>(m, "Vector2DArray", py::buffer_protocol())
+        .def(py::init<>())
+        .def(py::init<size_t>(), py::arg("n"))
+        .def(py::init([](const std::vector<Vector2D>& points) {
+            Vector2DArray a;
+            a.items = points;
+            return a;
+        }))
+        .def(py::init([](py::array_t<float, py::array::c_style | py::array::forcecast> xy) {
+            if (xy.ndim() != 2 || xy.shape(1) != 2) throw std::invalid_argument("points must have shape (n, 2)");
+            return Vector2DArray(xy.data(), (size_t)xy.shape(0));
+        }))
+        .def_buffer([](Vector2DArray &a) -> py::buffer_info {
+            return py::buffer_info(a.floats(), sizeof(float), py::format_descriptor<float>::format(), 2,
+                                   { (py::ssize_t)a.size(), (py::ssize_t)2 },
+                                   { (py::ssize_t)sizeof(Vector2D), (py::ssize_t)sizeof(float) });
+        })
+        .def("__len__", &Vector2DArray::size)
+        .def("__getitem__", [](const Vector2DArray &a, py::ssize_t i) {
+            if (i < 0) i += (py::ssize_t)a.size();
+            if (i < 0 || i >= (py::ssize_t)a.size()) throw py::index_error();
+            return a.items[i];
+        })
+        .def("__setitem__", [](Vector2DArray &a, py::ssize_t i, const Vector2D &v) {
+            if (i < 0) i += (py::ssize_t)a.size();
+            if (i < 0 || i >= (py::ssize_t)a.size()) throw py::index_error();
+            a.items[i] = v;
+        })
+        .def("append", [](Vector2DArray &a, const Vector2D &v) { a.items.push_back(v); })
+        .def("__add__", [](const Vector2DArray &a, const Vector2DArray &b) {
+            if (a.size() != b.size()) throw std::invalid_argument("Vector2DArray sizes differ");
+            return a + b;
+        })
+        .def("__add__", [](const Vector2DArray &a, const Vector2D &v) { return a + v; })
+        .def("__sub__", [](const Vector2DArray &a, const Vector2DArray &b) {
+            if (a.size() != b.size()) throw std::invalid_argument("Vector2DArray sizes differ");
+            return a - b;
+        })
+        .def("__sub__", [](const Vector2DArray &a, const Vector2D &v) { return a - v; })
+        .def("__mul__", [](const Vector2DArray &a, float n) { return a * n; })
+        .def("__rmul__", [](const Vector2DArray &a, float n) { return a * n; })
+        .def("__truediv__", [](const Vector2DArray &a, float n) { return a / n; })
+        .def("mag", [](const Vector2DArray &a) {
+            std::vector<float> m = a.mag();
+            return py::array_t<float>((py::ssize_t)m.size(), m.data());
+        })
+        .def("normalized", &Vector2DArray::normalized)
+        .def("limit", &Vector2DArray::limited, py::arg("max"))
+        .def("__repr__", [](const Vector2DArray &a) {
+            return "<Vector2DArray of " + std::to_string(a.size()) + " points>";
+        });
+
     py::class_<Boid>(m, "Boid")
         .def(py::init<float, float>())
         .def_readwrite("pos", &Boid::pos)
@@ -28,11 +175,589 @@ PYBIND11_MODULE(boid_engine, m) {
         .def("flock", &Boid::flock)
         .def("seek", &Boid::seek);
 
+    py::enum_<SimParam>(m, "Param")
+        .value("MAX_SPEED", PARAM_MAX_SPEED)
+        .value("MAX_FORCE", PARAM_MAX_FORCE)
+        .value("FLOW_STRENGTH", PARAM_FLOW_STRENGTH)
+        .value("ALARM_DEPOSIT", PARAM_ALARM_DEPOSIT)
+        .value("ALARM_WEIGHT", PARAM_ALARM_WEIGHT)
+        .value("CONSUME_RATE", PARAM_CONSUME_RATE);
+
+    py::class_<SharedStateReader>(m, "SharedStateReader")
+        .def(py::init([](const std::string& name) {
+            std::unique_ptr<SharedStateReader> r(new SharedStateReader());
+            if (!r->open(name)) throw std::runtime_error("could not open shared-memory segment " + name);
+            return r;
+        }), py::arg("name"))
+        .def_property_readonly("width", &SharedStateReader::width)
+        .def_property_readonly("height", &SharedStateReader::height)
+        .def_property_readonly("frames_published", &SharedStateReader::framesPublished)
+        .def("latest", [](py::object selfObj) -> py::object {
+            // (state, step, token): a read-only zero-copy (count, 4) view of
+            // the newest frame. Check is_valid(token) after using it. Each
+            // view pins the mapping: close() refuses while one is alive.
+            SharedStateReader &self = selfObj.cast<SharedStateReader &>();
+            SharedStateReader::Frame f;
+            if (!self.latest(f)) return py::none();
+            py::array_t<float> view(std::vector<py::ssize_t>{ (py::ssize_t)f.count, 4 }, f.data,
+                                    reader_view_owner(selfObj, self));
+            view.attr("setflags")(py::arg("write") = false);
+            return py::make_tuple(view, f.step, py::make_tuple(f.slot, f.seq));
+        })
+        .def("is_valid", [](SharedStateReader &self, py::tuple token) {
+            SharedStateReader::Frame f;
+            f.slot = token[0].cast<uint32_t>();
+            f.seq = token[1].cast<uint64_t>();
+            return self.isValid(f);
+        })
+        .def("close", [](SharedStateReader &self) {
+            if (!self.close())
+                throw std::runtime_error("views returned by latest() are still alive; drop them before close()");
+        });
+
+    py::enum_<SpawnLayout>(m, "Layout")
+        .value("UNIFORM", SPAWN_UNIFORM)
+        .value("POISSON", SPAWN_POISSON)
+        .value("SCHOOLS", SPAWN_SCHOOLS)
+        .value("MILL", SPAWN_MILL);
+
+    py::class_<SpawnSpec>(m, "SpawnSpec")
+        .def(py::init([](SpawnLayout layout, uint64_t seed, float speed, float min_distance, int schools,
+                         float heading_jitter, Vector2D center, float inner_radius, float outer_radius, bool clockwise) {
+            SpawnSpec s;
+            s.layout = layout;
+            s.seed = seed;
+            s.speed = speed;
+            s.minDistance = check_min_distance(min_distance);
+            s.schools = schools;
+            s.headingJitter = heading_jitter;
+            s.center = center;
+            s.innerRadius = inner_radius;
+            s.outerRadius = outer_radius;
+            s.clockwise = clockwise;
+            return s;
+        }), py::arg("layout") = SPAWN_POISSON, py::arg("seed") = 1, py::arg("speed") = 2.0f,
+            py::arg("min_distance") = 0.0f, py::arg("schools") = 8, py::arg("heading_jitter") = 0.3f,
+            py::arg("center") = Vector2D(-1.0f, -1.0f), py::arg("inner_radius") = 0.0f,
+            py::arg("outer_radius") = 0.0f, py::arg("clockwise") = false)
+        .def_readwrite("layout", &SpawnSpec::layout)
+        .def_readwrite("seed", &SpawnSpec::seed)
+        .def_readwrite("speed", &SpawnSpec::speed)
+        .def_property("min_distance",
+            [](const SpawnSpec &s) { return s.minDistance; },
+            [](SpawnSpec &s, float d) { s.minDistance = check_min_distance(d); })
+        .def_readwrite("schools", &SpawnSpec::schools)
+        .def_readwrite("heading_jitter", &SpawnSpec::headingJitter)
+        .def_readwrite("center", &SpawnSpec::center)
+        .def_readwrite("inner_radius", &SpawnSpec::innerRadius)
+        .def_readwrite("outer_radius", &SpawnSpec::outerRadius)
+        .def_readwrite("clockwise", &SpawnSpec::clockwise);
+
+    // (n, 4) rows of x, y, vx, vy for a layout, e.g. to inspect or edit
+    // before add_boids
+    m.def("generate_boids", [](const SpawnSpec &spec, int count, float width, float height) {
+        if (count < 0 || width <= 0.0f || height <= 0.0f)
+            throw std::invalid_argument("count must be >= 0 and the world size positive");
+        std::vector<float> rows;
+        {
+            py::gil_scoped_release release;
+            generateBoids(spec, count, width, height, rows);
+        }
+        py::array_t<float> out({(py::ssize_t)count, (py::ssize_t)4});
+        if (count > 0) std::memcpy(out.mutable_data(), rows.data(), rows.size() * sizeof(float));
+        return out;
+    }, py::arg("spec"), py::arg("count"), py::arg("width"), py::arg("height"));
+
     py::class_<Simulation>(m, "Simulation")
         .def(py::init<int, float, float>())
-        .def("step", &Simulation::step)
+        // Seeded layout instead of rand() positions
+        .def(py::init<int, float, float, const SpawnSpec&>(), py::arg("count"), py::arg("width"), py::arg("height"),
+             py::arg("spawn"))
+        .def("spawn", [](Simulation &self, const SpawnSpec &spec, int count) {
+            if (count < 0) throw std::invalid_argument("count must be >= 0");
+            self.spawn(spec, count);
+        }, py::arg("spec"), py::arg("count"))
+        .def("step", (void (Simulation::*)(Vector2D)) &Simulation::step)
+        .def("step", (void (Simulation::*)()) &Simulation::step)
+        .def("step", (void (Simulation::*)(const Vector2DArray&)) &Simulation::step)
+        // Removed boids keep their rows until compaction (see alive_mask)
         .def("remove_boids", &Simulation::remove_boids)
-        .def_readwrite("boids", &Simulation::boids)
+        .def("compact", [](Simulation &self) { self.compact(); })
+        .def_readwrite("compact_threshold", &Simulation::compactThreshold)
+        .def_property_readonly("alive_count", [](Simulation &self) { return self.tombstones.aliveCount(); })
+        .def_property_readonly("dead_count", [](Simulation &self) { return self.tombstones.deadCount(); })
+        .def("alive_mask", [](Simulation &self) {
+            py::array_t<bool> out((py::ssize_t)self.boids.size());
+            bool* o = out.mutable_data();
+            for (py::ssize_t i = 0; i < out.size(); ++i) o[i] = !self.tombstones.isDead((int)i);
+            return out;
+        })
+        .def("add_boids", [](Simulation &self, py::array_t<float, py::array::c_style | py::array::forcecast> rows) {
+            if (rows.ndim() != 2 || (rows.shape(1) != 2 && rows.shape(1) != 4))
+                throw std::invalid_argument("boids must have shape (n, 2) or (n, 4)");
+            self.add_boids(rows.data(), (int)rows.shape(0), (int)rows.shape(1));
+        })
+        .def("set_param", &Simulation::set_param)
+        .def_readwrite("predator", &Simulation::predator)
+        // All predators used by step() without arguments: `predator` plus any extras
+        .def_property("predators",
+            [](Simulation &self) {
+                Vector2DArray a;
+                a.items.push_back(self.predator);
+                a.items.insert(a.items.end(), self.extraPredators.begin(), self.extraPredators.end());
+                return a;
+            },
+            [](Simulation &self, const Vector2DArray &a) {
+                self.predator = a.size() > 0 ? a.items[0] : Vector2D(-1000.0f, -1000.0f);
+                self.extraPredators.assign(a.items.begin() + std::min<size_t>(1, a.size()), a.items.end());
+            })
+        // Command queue: safe to call while another thread is stepping.
+        // Each push returns False if the queue is full.
+        .def("push_predator", [](Simulation &self, float x, float y) {
+            Command c;
+            c.type = Command::SET_PREDATOR;
+            c.x = x;
+            c.y = y;
+            return self.commands.push(std::move(c));
+        })
+        .def("push_remove_boids", [](Simulation &self, std::vector<int> indices) {
+            Command c;
+            c.type = Command::REMOVE_BOIDS;
+            c.indices = std::move(indices);
+            return self.commands.push(std::move(c));
+        })
+        .def("push_add_boids", [](Simulation &self, py::array_t<float, py::array::c_style | py::array::forcecast> rows) {
+            if (rows.ndim() != 2 || (rows.shape(1) != 2 && rows.shape(1) != 4))
+                throw std::invalid_argument("boids must have shape (n, 2) or (n, 4)");
+            Command c;
+            c.type = Command::ADD_BOIDS;
+            py::ssize_t k = rows.shape(0);
+            c.rows.resize(k * 4);
+            // Queue rows as (x, y, vx, vy); a random heading for (x, y) input
+            for (py::ssize_t i = 0; i < k; ++i) {
+                Boid b(rows.at(i, 0), rows.at(i, 1));
+                c.rows[i * 4 + 0] = b.pos.x;
+                c.rows[i * 4 + 1] = b.pos.y;
+                c.rows[i * 4 + 2] = rows.shape(1) == 4 ? rows.at(i, 2) : b.vel.x;
+                c.rows[i * 4 + 3] = rows.shape(1) == 4 ? rows.at(i, 3) : b.vel.y;
+            }
+            return self.commands.push(std::move(c));
+        })
+        .def("push_set_param", [](Simulation &self, SimParam param, float value) {
+            Command c;
+            c.type = Command::SET_PARAM;
+            c.param = param;
+            c.value = value;
+            return self.commands.push(std::move(c));
+        })
+        .def_property_readonly("pending_commands", [](Simulation &self) { return self.commands.size(); })
+        // A copy of the boids; mutate through add_boids/remove_boids/set_param
+        // (or the command queue) so tombstones and trails stay in sync
+        .def_readonly("boids", &Simulation::boids)
+        // 0 = choose per phase automatically, n > 0 = always use n threads
+        .def_property("threads",
+            [](Simulation &self) { return self.tuner.getOverride(); },
+            [](Simulation &self, int n) {
+                if (n < 0) throw std::invalid_argument("threads must be >= 0");
+                self.tuner.setOverride(n);
+            })
+        .def_property_readonly("phase_threads", [](Simulation &self) {
+            py::dict d;
+            d["flock"] = self.tuner.lastThreads(PHASE_FLOCK);
+            d["diffuse"] = self.tuner.lastThreads(PHASE_DIFFUSE);
+            d["publish"] = self.tuner.lastThreads(PHASE_PUBLISH);
+            d["attract"] = self.tuner.lastThreads(PHASE_ATTRACT);
+            d["stream"] = self.tuner.lastThreads(PHASE_STREAM);
+            d["interpolate"] = self.tuner.lastThreads(PHASE_INTERP);
+            d["render"] = self.tuner.lastThreads(PHASE_RENDER);
+            d["pair_correlation"] = self.tuner.lastThreads(PHASE_PAIRS);
+            d["local_density"] = self.tuner.lastThreads(PHASE_DENSITY);
+            d["nearest_neighbor"] = self.tuner.lastThreads(PHASE_NEAREST);
+            d["arrow_export"] = self.tuner.lastThreads(PHASE_EXPORT);
+            return d;
+        })
+        .def_readwrite("flow_strength", &Simulation::flowStrength)
+        .def("set_flow_field", [](Simulation &self, py::array_t<float, py::array::c_style | py::array::forcecast> field) {
+            if (field.ndim() != 3 || field.shape(2) != 2)
+                throw std::invalid_argument("flow field must have shape (rows, cols, 2)");
+            self.set_flow_field(field.data(), (int)field.shape(1), (int)field.shape(0));
+        })
+        .def("push_flow_frame", [](Simulation &self, py::array_t<float, py::array::c_style | py::array::forcecast> field) {
+            if (field.ndim() != 3 || field.shape(0) != self.flow.numRows() ||
+                field.shape(1) != self.flow.numCols() || field.shape(2) != 2)
+                throw std::invalid_argument("frame shape must match the loaded flow field");
+            return self.push_flow_frame(field.data());
+        })
+        .def("clear_flow_field", &Simulation::clear_flow_field)
+        .def("set_attractors", [](Simulation &self, py::array_t<float, py::array::c_style | py::array::forcecast> data) {
+            // Rows of (x, y, radius, strength, capacity)
+            if (data.ndim() != 2 || data.shape(1) != 5)
+                throw std::invalid_argument("attractors must have shape (n, 5): x, y, radius, strength, capacity");
+            self.set_attractors(data.data(), (int)data.shape(0));
+        })
+        .def("get_attractors", [](Simulation &self) {
+            int m = self.attractors.size();
+            py::array_t<float> out(std::vector<py::ssize_t>{ (py::ssize_t)m, 5 });
+            float* o = out.mutable_data();
+            for (int i = 0; i < m; ++i) {
+                const Attractor& a = self.attractors[i];
+                o[i * 5 + 0] = a.pos.x;
+                o[i * 5 + 1] = a.pos.y;
+                o[i * 5 + 2] = a.radius;
+                o[i * 5 + 3] = a.strength;
+                o[i * 5 + 4] = a.capacity;
+            }
+            return out;
+        })
+        .def("clear_attractors", &Simulation::clear_attractors)
+        .def_property("attractor_consume_rate",
+            [](Simulation &self) { return self.attractors.consumeRate; },
+            [](Simulation &self, float rate) { self.attractors.consumeRate = rate; })
+        .def("set_obstacles", [](Simulation &self, py::array_t<float, py::array::c_style | py::array::forcecast> data) {
+            if (data.ndim() != 2 || data.shape(1) != 3)
+                throw std::invalid_argument("obstacles must have shape (n, 3): x, y, radius");
+            self.set_obstacles(data.data(), (int)data.shape(0));
+        })
+        .def("get_obstacles", [](Simulation &self) {
+            int m = self.obstacles.size();
+            py::array_t<float> out(std::vector<py::ssize_t>{ (py::ssize_t)m, 3 });
+            float* o = out.mutable_data();
+            for (int i = 0; i < m; ++i) {
+                o[i * 3 + 0] = self.obstacles[i].pos.x;
+                o[i * 3 + 1] = self.obstacles[i].pos.y;
+                o[i * 3 + 2] = self.obstacles[i].radius;
+            }
+            return out;
+        })
+        .def("clear_obstacles", [](Simulation &self) { self.obstacles.clear(); })
+        .def_readwrite("obstacle_weight", &Simulation::obstacleWeight)
+        .def_property("obstacle_margin",
+            [](Simulation &self) { return self.obstacles.margin; },
+            [](Simulation &self, float margin) { self.obstacles.margin = margin; })
+        .def("set_alarm_field", [](Simulation &self, int cols, int rows) {
+            if (!self.set_alarm_field(cols, rows)) throw std::invalid_argument("cols and rows must be positive");
+        }, py::arg("cols"), py::arg("rows"))
+        .def("clear_alarm_field", &Simulation::clear_alarm_field)
+        .def("get_alarm_field", [](Simulation &self) {
+            // Copy: the field is double-buffered and swaps every step
+            py::array_t<float> out(std::vector<py::ssize_t>{ self.alarm.numRows(), self.alarm.numCols() });
+            std::copy(self.alarm.data(), self.alarm.data() + out.size(), out.mutable_data());
+            return out;
+        })
+        .def_readwrite("alarm_deposit", &Simulation::alarmDeposit)
+        .def_readwrite("alarm_weight", &Simulation::alarmWeight)
+        .def_property("alarm_diffusion",
+            [](Simulation &self) { return self.alarm.diffusion; },
+            [](Simulation &self, float d) {
+                if (!(d >= 0.0f && d <= ScalarField::MAX_DIFFUSION))
+                    throw std::invalid_argument("alarm_diffusion must be in [0, 0.25]");
+                self.alarm.diffusion = d;
+            })
+        .def_property("alarm_decay",
+            [](Simulation &self) { return self.alarm.decay; },
+            [](Simulation &self, float d) {
+                if (!(d >= 0.0f && d <= 1.0f)) throw std::invalid_argument("alarm_decay must be in [0, 1]");
+                self.alarm.decay = d;
+            })
+        .def("neighbor_graph", [](Simulation &self, py::array indptr, py::array indices,
+                                  py::object distances, float radius, bool flock_neighbors) {
+            // Fills preallocated CSR buffers and returns the edge count. If it
+            // exceeds len(indices), only indptr is written: grow and retry.
+            int rows = self.row_count();
+            py::ssize_t n = rows;
+            int64_t* ip = out_buffer<int64_t>(indptr, n + 1, "indptr");
+            int32_t* ix = out_buffer<int32_t>(indices, 0, "indices");
+            float* d = nullptr;
+            int64_t capacity = indices.size();
+            if (!distances.is_none()) {
+                py::array da = distances.cast<py::array>();
+                d = out_buffer<float>(da, 0, "distances");
+                capacity = std::min<int64_t>(capacity, da.size());
+            }
+            int64_t nnz;
+            {
+                py::gil_scoped_release release;
+                nnz = self.neighbor_graph(rows, ip, ix, d, capacity, radius, flock_neighbors);
+            }
+            if (nnz < 0) throw std::runtime_error(ROWS_CHANGED);
+            return nnz;
+        }, py::arg("indptr"), py::arg("indices"), py::arg("distances") = py::none(),
+           py::arg("radius") = 50.0f, py::arg("flock_neighbors") = false)
+        .def("wavefront", [](Simulation &self, py::object seeds, py::object predator,
+                             int max_hops, float radius, bool flock_neighbors) {
+            // Returns (hops per boid, frontier size per hop). Seeds default to
+            // the boids inside the predator's panic radius.
+            // Nothing is compacted, so seeds and hops share the caller's row
+            // indices; dead rows get -1.
+            std::vector<int> s;
+            if (!seeds.is_none()) s = seeds.cast<std::vector<int>>();
+            else if (py::isinstance<Vector2DArray>(predator)) {
+                const Vector2DArray &p = predator.cast<const Vector2DArray &>();
+                s = self.panicked(p.data(), (int)p.size());
+            }
+            else if (!predator.is_none()) {
+                Vector2D p = predator.cast<Vector2D>();
+                s = self.panicked(&p, 1);
+            }
+            else throw std::invalid_argument("pass seeds or predator");
+
+            int rows = self.row_count();
+            py::array_t<int32_t> hops(rows);
+            int32_t* h = hops.mutable_data();
+            std::vector<int64_t> sizes;
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ok = self.wavefront(rows, s, max_hops, radius, flock_neighbors, h, sizes);
+            }
+            if (!ok) throw std::runtime_error(ROWS_CHANGED);
+            return py::make_tuple(hops, py::array_t<int64_t>((py::ssize_t)sizes.size(), sizes.data()));
+        }, py::arg("seeds") = py::none(), py::arg("predator") = py::none(), py::arg("max_hops") = -1,
+           py::arg("radius") = 50.0f, py::arg("flock_neighbors") = true)
+        .def("enable_trails", &Simulation::enable_trails, py::arg("length"))
+        .def("get_trails", [](Simulation &self) {
+            // Zero-copy (length, n) uint16 views of the quantised x and y
+            // history. Multiply by trail_scale to get world units; the newest
+            // row is trail_head. The views dangle once boids are added (also
+            // through push_add_boids or spawn), compacted or restored, or
+            // trails are re-enabled: re-fetch when trail_generation changes.
+            auto shape = std::vector<py::ssize_t>{ self.trails.numSlots(), self.trails.numBoids() };
+            py::object owner = py::cast(self);
+            return py::make_tuple(
+                py::array_t<uint16_t>(shape, self.trails.xData(), owner),
+                py::array_t<uint16_t>(shape, self.trails.yData(), owner));
+        })
+        .def_property_readonly("trail_head", [](Simulation &self) {
+            return self.trails.active() ? self.trails.latestSlot() : -1;
+        })
+        .def_property_readonly("trail_filled", [](Simulation &self) { return self.trails.filledSlots(); })
+        .def_property_readonly("trail_generation", [](Simulation &self) { return self.trails.generation(); })
+        .def_property_readonly("trail_scale", [](Simulation &self) {
+            return self.trails.active() ? py::make_tuple(self.trails.scaleX(), self.trails.scaleY())
+                                        : py::make_tuple(0.0f, 0.0f);
+        })
+        .def("enable_rewind", [](Simulation &self, size_t max_bytes, int keyframe_interval) {
+            // Snapshots only hold resident boids, so paging would lose the rest
+            if (self.pager.active()) throw std::runtime_error("rewind is not available while paging");
+            if (!self.enable_rewind(max_bytes, keyframe_interval))
+                throw std::invalid_argument("max_bytes is smaller than one keyframe of the current boids");
+        }, py::arg("max_bytes") = (size_t)64 << 20, py::arg("keyframe_interval") = 60)
+        .def("disable_rewind", &Simulation::disable_rewind)
+        .def("rewind", &Simulation::rewind, py::arg("steps"))
+        .def_readonly("step_count", &Simulation::stepCount)
+        .def_property_readonly("rewind_bytes", [](Simulation &self) { return self.history.bytesUsed(); })
+        .def_property_readonly("rewind_available", [](Simulation &self) {
+            // Number of steps back that can currently be restored
+            if (!self.history.active() || self.history.frameCount() == 0) return (uint64_t)0;
+            return self.stepCount - self.history.oldestStep();
+        })
+        .def("enable_paging", [](Simulation &self, const std::string& directory, float region_size,
+                                 float active_radius, int interval) {
+            if (self.history.active()) throw std::runtime_error("disable rewind before enabling paging");
+            if (region_size <= 0.0f) throw std::invalid_argument("region_size must be positive");
+            if (!self.enable_paging(directory, region_size, active_radius, interval))
+                throw std::runtime_error("could not page regions to " + directory);
+        }, py::arg("directory"), py::arg("region_size") = 2000.0f, py::arg("active_radius") = 2500.0f,
+           py::arg("interval") = 30)
+        .def("disable_paging", [](Simulation &self) {
+            if (!self.disable_paging())
+                throw std::runtime_error("could not read back every paged region; paging stays enabled");
+        })
+        .def("set_cameras", [](Simulation &self, py::array_t<float, py::array::c_style | py::array::forcecast> xy) {
+            if (xy.ndim() != 2 || xy.shape(1) != 2)
+                throw std::invalid_argument("cameras must have shape (n, 2)");
+            self.set_cameras(xy.data(), (int)xy.shape(0));
+        })
+        .def_property_readonly("paged_boids", [](Simulation &self) { return self.pager.pagedCount(); })
+        .def_property_readonly("resident_regions", [](Simulation &self) { return self.pager.residentRegions(); })
+        .def_property_readonly("region_count", [](Simulation &self) { return self.pager.numRegions(); })
+        .def_property_readonly("page_read_errors", [](Simulation &self) { return self.pager.readFailures(); })
+        .def("enable_shared_publisher", [](Simulation &self, const std::string& name, int capacity) {
+            if (!self.enable_shared_publisher(name, capacity))
+                throw std::runtime_error("could not create shared-memory segment " + name);
+        }, py::arg("name"), py::arg("capacity") = 0)
+        .def("disable_shared_publisher", &Simulation::disable_shared_publisher)
+        .def("start_stream_server", [](Simulation &self, const std::string& address) {
+            if (!self.start_stream_server(address))
+                throw std::runtime_error("could not listen on " + address);
+        }, py::arg("address"))
+        .def("stop_stream_server", &Simulation::stop_stream_server)
+        .def_property_readonly("stream_subscribers", [](Simulation &self) { return self.streamer.subscriberCount(); })
+        .def("interpolate_positions", [](Simulation &self, float alpha, py::object out) {
+            // (n, 2) float32 positions at alpha between the last two steps,
+            // written into `out` if given to avoid an allocation per frame.
+            // A Vector2DArray out is resized to fit.
+            int rows = self.row_count();
+            py::ssize_t n = rows;
+            py::object result = out;
+            float* o;
+            if (py::isinstance<Vector2DArray>(out)) {
+                Vector2DArray &pts = out.cast<Vector2DArray &>();
+                pts.items.resize((size_t)n);
+                o = pts.floats();
+            } else {
+                py::array buf = out.is_none() ? py::array(py::array_t<float>(std::vector<py::ssize_t>{ n, 2 }))
+                                              : out.cast<py::array>();
+                o = out_buffer<float>(buf, n * 2, "out");
+                result = buf;
+            }
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ok = self.interpolate_positions(rows, alpha, o);
+            }
+            if (!ok) throw std::runtime_error(ROWS_CHANGED);
+            return result;
+        }, py::arg("alpha"), py::arg("out") = py::none())
+        .def("render_geometry", [](Simulation &self, py::object head, py::object body, py::object tail,
+                                   py::object heading, py::object color, py::object triangles,
+                                   int color_levels, float head_length, float tail_length) {
+            // Fills whichever preallocated buffers are given: head/body/tail
+            // (n, 2) int32, heading (n,) float32, color (n,) uint8,
+            // triangles (n, 3, 2) int32.
+            int rows = self.row_count();
+            py::ssize_t n = rows;
+            if (color_levels < 1 || color_levels > 256) throw std::invalid_argument("color_levels must be in 1..256");
+            py::array a;
+            int32_t* h = nullptr; int32_t* b = nullptr; int32_t* t = nullptr; int32_t* tri = nullptr;
+            float* hd = nullptr; uint8_t* c = nullptr;
+            if (!head.is_none()) { a = head.cast<py::array>(); h = out_buffer<int32_t>(a, n * 2, "head"); }
+            if (!body.is_none()) { a = body.cast<py::array>(); b = out_buffer<int32_t>(a, n * 2, "body"); }
+            if (!tail.is_none()) { a = tail.cast<py::array>(); t = out_buffer<int32_t>(a, n * 2, "tail"); }
+            if (!heading.is_none()) { a = heading.cast<py::array>(); hd = out_buffer<float>(a, n, "heading"); }
+            if (!color.is_none()) { a = color.cast<py::array>(); c = out_buffer<uint8_t>(a, n, "color"); }
+            if (!triangles.is_none()) { a = triangles.cast<py::array>(); tri = out_buffer<int32_t>(a, n * 6, "triangles"); }
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ok = self.render_geometry(rows, h, b, t, hd, c, color_levels, tri, head_length, tail_length);
+            }
+            if (!ok) throw std::runtime_error(ROWS_CHANGED);
+        }, py::arg("head") = py::none(), py::arg("body") = py::none(), py::arg("tail") = py::none(),
+           py::arg("heading") = py::none(), py::arg("color") = py::none(), py::arg("triangles") = py::none(),
+           py::arg("color_levels") = 8, py::arg("head_length") = 2.0f, py::arg("tail_length") = 3.0f)
+        .def("run_realtime", [](Simulation &self, double hz, int callback_every_n,
+                                py::object callback, long long max_steps) {
+            // The loop runs without the GIL; it is taken once per frame to
+            // check for signals, so Ctrl-C ends the run even without a
+            // callback, and the callback is called every callback_every_n
+            // frames from the same hook. A callback returning False ends it.
+            const long long every = std::max(callback_every_n, 1);
+            long long frame = 0;
+            std::function<bool()> cb = [&callback, every, &frame]() {
+                py::gil_scoped_acquire gil;
+                if (PyErr_CheckSignals() != 0) throw py::error_already_set();
+                if (callback.is_none() || ++frame % every != 0) return true;
+                py::object r = callback();
+                return r.is_none() || r.cast<bool>();
+            };
+            py::gil_scoped_release release;
+            return self.run_realtime(hz, 1, cb, max_steps);
+        }, py::arg("hz") = 60.0, py::arg("callback_every_n") = 1, py::arg("callback") = py::none(),
+           py::arg("max_steps") = 0)
+        .def("stop_realtime", &Simulation::stop_realtime)
+        .def("pair_correlation", [](Simulation &self, float r_max, int bins, py::object edges) {
+            // Returns (g, edges). Pass explicit bin edges for non-uniform bins.
+            py::array_t<float> e;
+            if (edges.is_none()) {
+                if (bins < 1 || r_max <= 0.0f) throw std::invalid_argument("need bins >= 1 and r_max > 0");
+                e = py::array_t<float>(bins + 1);
+                float* p = e.mutable_data();
+                for (int k = 0; k <= bins; ++k) p[k] = r_max * k / bins;
+            } else {
+                e = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(edges);
+                if (!e || e.ndim() != 1 || e.size() < 2)
+                    throw std::invalid_argument("edges must be a 1-D array of at least two values");
+            }
+            int nbins = (int)e.size() - 1;
+            py::array_t<double> g(nbins);
+            {
+                py::gil_scoped_release release;
+                self.pair_correlation(e.data(), nbins, g.mutable_data());
+            }
+            return py::make_tuple(g, e);
+        }, py::arg("r_max") = 100.0f, py::arg("bins") = 50, py::arg("edges") = py::none())
+        .def("local_density", [](Simulation &self, float radius) {
+            int rows = self.row_count();
+            py::array_t<float> out(rows);
+            float* o = out.mutable_data();
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ok = self.local_density(rows, radius, o);
+            }
+            if (!ok) throw std::runtime_error(ROWS_CHANGED);
+            return out;
+        }, py::arg("radius") = 50.0f)
+        .def("nearest_neighbor_distances", [](Simulation &self, float max_radius) {
+            int rows = self.row_count();
+            py::array_t<float> out(rows);
+            float* o = out.mutable_data();
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ok = self.nearest_neighbor_distances(rows, max_radius, o);
+            }
+            if (!ok) throw std::runtime_error(ROWS_CHANGED);
+            return out;
+        }, py::arg("max_radius") = 100.0f)
+        // Arrow PyCapsule interface: pyarrow.record_batch(sim), polars.from_arrow(sim),
+        // DuckDB etc. import the state columns (id, x, y, vx, vy) without copying them.
+        // requested_schema is ignored; the export has a single fixed schema.
+        .def("__arrow_c_schema__", [](Simulation &) { return arrow_schema_capsule(); })
+        .def("__arrow_c_array__", [](Simulation &self, py::object) {
+            ArrowArray* a = new ArrowArray;
+            {
+                py::gil_scoped_release release;
+                std::lock_guard<std::mutex> lock(self.stateMutex);
+                self.tuned(PHASE_EXPORT, (long long)self.boids.size(),
+                           [&](int threads) { exportBoidArray(self.boids, self.tombstones, a, threads); });
+            }
+            py::object array = py::reinterpret_steal<py::object>(PyCapsule_New(a, "arrow_array", &release_arrow_array));
+            return py::make_tuple(arrow_schema_capsule(), array);
+        }, py::arg("requested_schema") = py::none())
+        .def("__arrow_c_stream__", [](Simulation &self, py::object) {
+            ArrowArrayStream* st = new ArrowArrayStream;
+            {
+                py::gil_scoped_release release;
+                std::lock_guard<std::mutex> lock(self.stateMutex);
+                self.tuned(PHASE_EXPORT, (long long)self.boids.size(),
+                           [&](int threads) { exportBoidStream(self.boids, self.tombstones, st, threads); });
+            }
+            return py::reinterpret_steal<py::object>(PyCapsule_New(st, "arrow_array_stream", &release_arrow_stream));
+        }, py::arg("requested_schema") = py::none())
+        // DLPack export of the get_full_state() view: np.from_dlpack(sim),
+        // torch.from_dlpack(sim). Like that view it aliases the boid array,
+        // so it is invalidated by compaction or by adding boids.
+        .def("__dlpack__", [](py::object selfObj, py::object, py::kwargs) {
+            Simulation &self = selfObj.cast<Simulation &>();
+            Py_INCREF(selfObj.ptr());
+            DLBoidTensor* t = makeBoidStateTensor(self.boids, selfObj.ptr(), &release_dlpack_tensor);
+            return py::reinterpret_steal<py::object>(PyCapsule_New(&t->managed, "dltensor", &release_dlpack_capsule));
+        }, py::arg("stream") = py::none())
+        .def("__dlpack_device__", [](Simulation &) { return py::make_tuple((int)kDLCPU, 0); })
+        // Pickling. With protocol 5 the boid records travel as a PickleBuffer,
+        // so pickle.dumps(sim, protocol=5, buffer_callback=...) hands them over
+        // out of band without a copy. Boids, their tombstone bitmap, step
+        // count, predator and the scalar parameters are kept; fields,
+        // attractors, trails, history, paging and publishers/servers are not.
+        .def("__reduce_ex__", [](py::object selfObj, int protocol) {
+            Simulation &self = selfObj.cast<Simulation &>();
+            py::ssize_t bytes = (py::ssize_t)(self.boids.size() * sizeof(Boid));
+            py::array_t<uint8_t> raw(std::vector<py::ssize_t>{ bytes },
+                                     reinterpret_cast<uint8_t*>(self.boids.data()), selfObj);
+            py::object state;
+            if (protocol >= 5) state = py::module::import("pickle").attr("PickleBuffer")(raw);
+            else state = py::bytes(reinterpret_cast<const char*>(raw.data()), (size_t)bytes);
+            py::tuple params = py::make_tuple(self.stepCount, self.predator.x, self.predator.y,
+                                              self.flowStrength, self.alarmDeposit, self.alarmWeight,
+                                              self.compactThreshold, self.attractors.consumeRate,
+                                              self.maxSpeed, self.maxForce);
+            py::bytes dead(reinterpret_cast<const char*>(self.tombstones.bits()),
+                           Tombstones::bytesFor(self.tombstones.size()));
+            return py::make_tuple(py::module::import("boid_engine").attr("_restore_simulation"),
+                                  py::make_tuple(self.width, self.height, state, params, dead));
+        }, py::arg("protocol"))
         .def("get_all_positions", [](Simulation &self) {
             std::vector<float> pos_data;
             pos_data.reserve(self.boids.size() * 2);
@@ -54,4 +779,27 @@ PYBIND11_MODULE(boid_engine, m) {
                 py::cast(self)                              
             );
     });
-}
\ No newline at end of file
+
+    m.def("_restore_simulation", [](float width, float height, py::buffer state, py::tuple params, py::bytes dead) {
+        // Inverse of Simulation.__reduce_ex__
+        py::buffer_info info = state.request();
+        size_t bytes = (size_t)info.size * (size_t)info.itemsize;
+        if (bytes % sizeof(Boid) != 0) throw std::invalid_argument("state is not a whole number of boids");
+        const int count = (int)(bytes / sizeof(Boid));
+        std::string deadBits = dead;
+        if (deadBits.size() != Tombstones::bytesFor(count))
+            throw std::invalid_argument("tombstone bitmap does not match the boid count");
+        std::unique_ptr<Simulation> sim(new Simulation(0, width, height));
+        sim->load_records(info.ptr, count, deadBits.data());
+        sim->stepCount = params[0].cast<uint64_t>();
+        sim->predator = Vector2D(params[1].cast<float>(), params[2].cast<float>());
+        sim->flowStrength = params[3].cast<float>();
+        sim->alarmDeposit = params[4].cast<float>();
+        sim->alarmWeight = params[5].cast<float>();
+        sim->compactThreshold = params[6].cast<float>();
+        sim->attractors.consumeRate = params[7].cast<float>();
+        sim->maxSpeed = params[8].cast<float>();
+        sim->maxForce = params[9].cast<float>();
+        return sim;
+    });
+}
@@ -0,0 +1,131 @@
+#include "boid_engine_c.h"
+#include "simulation.h"
+#include <exception>
+#include <string>
+
+struct BoidSim {
+    Simulation sim;
+    BoidSim(int count, float w, float h) : sim(count, w, h) {}
+};
+
+static thread_local std::string lastError;
+
+static int fail(int status, const char* what) {
+    lastError = what;
+    return status;
+}
+
+// Runs f, turning exceptions into BOID_ERR_RUNTIME so none cross the ABI.
+template <typename F>
+static int guarded(F f) {
+    try {
+        f();
+        return BOID_OK;
+    } catch (const std::exception& e) {
+        return fail(BOID_ERR_RUNTIME, e.what());
+    } catch (...) {
+        return fail(BOID_ERR_RUNTIME, "unknown error");
+    }
+}
+
+extern "C" {
+
+int boid_abi_version(void) { return BOID_ENGINE_C_ABI_VERSION; }
+
+const char* boid_last_error(void) { return lastError.c_str(); }
+
+BoidSim* boid_sim_create(int32_t count, float width, float height) {
+    if (count < 0 || !(width >= 1.0f) || !(height >= 1.0f)) {
+        fail(BOID_ERR_ARGUMENT, "count must be >= 0 and the world at least 1x1");
+        return nullptr;
+    }
+    BoidSim* s = nullptr;
+    guarded([&] { s = new BoidSim(count, width, height); });
+    return s;
+}
+
+void boid_sim_destroy(BoidSim* sim) { delete sim; }
+
+int boid_sim_set_predators(BoidSim* sim, const float* xy, int32_t count) {
+    if (!sim || count < 0 || (count > 0 && !xy)) return fail(BOID_ERR_ARGUMENT, "bad predator list");
+    return guarded([&] {
+        Simulation& s = sim->sim;
+        s.predator = count > 0 ? Vector2D(xy[0], xy[1]) : Vector2D(-1000.0f, -1000.0f);
+        s.extraPredators.clear();
+        for (int i = 1; i < count; ++i) s.extraPredators.emplace_back(xy[2 * i], xy[2 * i + 1]);
+    });
+}
+
+int boid_sim_step(BoidSim* sim) {
+    if (!sim) return fail(BOID_ERR_ARGUMENT, "null simulation");
+    return guarded([&] { sim->sim.step(); });
+}
+
+int boid_sim_step_n(BoidSim* sim, int32_t steps) {
+    if (!sim || steps < 0) return fail(BOID_ERR_ARGUMENT, "bad step count");
+    return guarded([&] {
+        for (int i = 0; i < steps; ++i) sim->sim.step();
+    });
+}
+
+int32_t boid_sim_count(const BoidSim* sim) {
+    return sim ? static_cast<int32_t>(sim->sim.boids.size()) : 0;
+}
+
+int32_t boid_sim_alive_count(const BoidSim* sim) {
+    return sim ? sim->sim.tombstones.aliveCount() : 0;
+}
+
+uint64_t boid_sim_step_count(const BoidSim* sim) { return sim ? sim->sim.stepCount : 0; }
+
+int boid_sim_state_view(BoidSim* sim, BoidStateView* out) {
+    if (!sim || !out) return fail(BOID_ERR_ARGUMENT, "null simulation or view");
+    std::vector<Boid>& boids = sim->sim.boids;
+    const float* base = boids.empty() ? nullptr : &boids[0].pos.x;
+    out->x = base;
+    out->y = base ? base + 1 : nullptr;
+    out->vx = base ? &boids[0].vel.x : nullptr;
+    out->vy = base ? &boids[0].vel.y : nullptr;
+    out->stride = sizeof(Boid) / sizeof(float);
+    out->count = static_cast<int32_t>(boids.size());
+    return BOID_OK;
+}
+
+int boid_sim_get_state(const BoidSim* sim, float* out, int32_t capacity) {
+    if (!sim || !out) return fail(BOID_ERR_ARGUMENT, "null simulation or buffer");
+    const std::vector<Boid>& boids = sim->sim.boids;
+    if (capacity < static_cast<int32_t>(boids.size())) return fail(BOID_ERR_ARGUMENT, "buffer too small");
+    for (size_t i = 0; i < boids.size(); ++i) {
+        out[i * 4 + 0] = boids[i].pos.x;
+        out[i * 4 + 1] = boids[i].pos.y;
+        out[i * 4 + 2] = boids[i].vel.x;
+        out[i * 4 + 3] = boids[i].vel.y;
+    }
+    return BOID_OK;
+}
+
+int boid_sim_alive_mask(const BoidSim* sim, uint8_t* out, int32_t capacity) {
+    if (!sim || !out) return fail(BOID_ERR_ARGUMENT, "null simulation or buffer");
+    const int n = static_cast<int>(sim->sim.boids.size());
+    if (capacity < n) return fail(BOID_ERR_ARGUMENT, "buffer too small");
+    for (int i = 0; i < n; ++i) out[i] = sim->sim.tombstones.isDead(i) ? 0 : 1;
+    return BOID_OK;
+}
+
+int boid_sim_add(BoidSim* sim, const float* rows, int32_t count, int32_t stride) {
+    if (!sim || count < 0 || (count > 0 && !rows) || (stride != 2 && stride != 4))
+        return fail(BOID_ERR_ARGUMENT, "rows must be (x, y) or (x, y, vx, vy)");
+    return guarded([&] { sim->sim.add_boids(rows, count, stride); });
+}
+
+int boid_sim_remove(BoidSim* sim, const int32_t* indices, int32_t count) {
+    if (!sim || count < 0 || (count > 0 && !indices)) return fail(BOID_ERR_ARGUMENT, "bad index list");
+    return guarded([&] { sim->sim.remove_boids(std::vector<int>(indices, indices + count)); });
+}
+
+int boid_sim_compact(BoidSim* sim) {
+    if (!sim) return fail(BOID_ERR_ARGUMENT, "null simulation");
+    return guarded([&] { sim->sim.compact(); });
+}
+
+}
@@ -0,0 +1,96 @@
+#ifndef BOID_ENGINE_C_H
+#define BOID_ENGINE_C_H
+
+/*
+ * C ABI over Simulation for hosts that can't use C++ (Rust, C#, ...).
+ *
+ * A simulation is an opaque handle. Functions return BOID_OK (0) or a
+ * negative status; boid_last_error() describes the last failure on the
+ * calling thread. Every buffer is owned by the caller, except the state
+ * view, which points into the engine's own boid array.
+ *
+ * A handle may be used from one thread at a time.
+ */
+
+#include <stdint.h>
+
+#if defined(_WIN32) && !defined(BOID_ENGINE_C_STATIC)
+#  ifdef BOID_ENGINE_C_BUILD
+#    define BOID_API __declspec(dllexport)
+#  else
+#    define BOID_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define BOID_API __attribute__((visibility("default")))
+#else
+#  define BOID_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a signature or struct below changes. */
+#define BOID_ENGINE_C_ABI_VERSION 1
+
+enum {
+    BOID_OK = 0,
+    BOID_ERR_ARGUMENT = -1, /* null handle, bad count, buffer too small */
+    BOID_ERR_RUNTIME = -2   /* the engine threw (e.g. out of memory) */
+};
+
+typedef struct BoidSim BoidSim;
+
+/*
+ * Strided view of the boid array: row i is at x[i * stride], y[i * stride]
+ * etc. Dead (removed, not yet compacted) rows are flagged in the alive mask.
+ * Valid until the next call that adds, removes, compacts or steps (a step
+ * can compact when paging is on), so take it again after those.
+ */
+typedef struct BoidStateView {
+    const float* x;
+    const float* y;
+    const float* vx;
+    const float* vy;
+    int64_t stride; /* in floats */
+    int32_t count;  /* rows, including dead ones */
+} BoidStateView;
+
+BOID_API int boid_abi_version(void);
+BOID_API const char* boid_last_error(void);
+
+/* count boids at random positions in a width x height wrapped world.
+   Returns NULL on failure. */
+BOID_API BoidSim* boid_sim_create(int32_t count, float width, float height);
+BOID_API void boid_sim_destroy(BoidSim* sim);
+
+/* xy holds count (x, y) pairs; zero predators puts the predator offscreen. */
+BOID_API int boid_sim_set_predators(BoidSim* sim, const float* xy, int32_t count);
+
+BOID_API int boid_sim_step(BoidSim* sim);
+BOID_API int boid_sim_step_n(BoidSim* sim, int32_t steps);
+
+BOID_API int32_t boid_sim_count(const BoidSim* sim);
+BOID_API int32_t boid_sim_alive_count(const BoidSim* sim);
+BOID_API uint64_t boid_sim_step_count(const BoidSim* sim);
+
+BOID_API int boid_sim_state_view(BoidSim* sim, BoidStateView* out);
+
+/* Copies (x, y, vx, vy) rows into out, which holds capacity rows. */
+BOID_API int boid_sim_get_state(const BoidSim* sim, float* out, int32_t capacity);
+
+/* out[i] = 1 for alive rows, 0 for dead ones; out holds capacity bytes. */
+BOID_API int boid_sim_alive_mask(const BoidSim* sim, uint8_t* out, int32_t capacity);
+
+/* rows of (x, y) (stride 2, random heading) or (x, y, vx, vy) (stride 4) */
+BOID_API int boid_sim_add(BoidSim* sim, const float* rows, int32_t count, int32_t stride);
+
+/* Tombstones the given rows; out-of-range or already dead ones are ignored. */
+BOID_API int boid_sim_remove(BoidSim* sim, const int32_t* indices, int32_t count);
+BOID_API int boid_sim_compact(BoidSim* sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
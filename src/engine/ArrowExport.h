@@ -0,0 +1,245 @@
+#ifndef ARROWEXPORT_H
+#define ARROWEXPORT_H
+
+#include "Boid.h"
+#include "Tombstones.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <omp.h>
+
+// Export of the boid state through the Arrow C Data Interface, without an
+// Arrow dependency: the ABI structs are declared here as the spec allows.
+//
+// Boids are stored as an array of structs, so one parallel pass splits them
+// into column buffers owned by the export; consumers (pyarrow, Polars,
+// DuckDB) then import those buffers as they are. The batch is a struct
+// array with columns id (int32, row index), x, y, vx, vy (float32). Rows of
+// removed, not yet compacted boids are null.
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+struct ArrowArrayStream {
+    int (*get_schema)(struct ArrowArrayStream*, struct ArrowSchema* out);
+    int (*get_next)(struct ArrowArrayStream*, struct ArrowArray* out);
+    const char* (*get_last_error)(struct ArrowArrayStream*);
+    void (*release)(struct ArrowArrayStream*);
+    void* private_data;
+};
+
+#endif
+
+static const int ARROW_BOID_COLUMNS = 5;
+static const char* const ARROW_BOID_NAMES[ARROW_BOID_COLUMNS] = { "id", "x", "y", "vx", "vy" };
+
+// Column buffers shared by the struct array and its children; freed when
+// the last of them is released (children may be moved out separately).
+struct ArrowBoidColumns {
+    std::vector<uint8_t> validity; // empty when every row is valid
+    std::vector<int32_t> id;
+    std::vector<float> x, y, vx, vy;
+    int64_t nulls = 0;
+};
+
+struct ArrowArrayHolder {
+    std::shared_ptr<ArrowBoidColumns> columns;
+    const void* buffers[2];
+    ArrowArray* childArrays[ARROW_BOID_COLUMNS];
+    ArrowArray children[ARROW_BOID_COLUMNS];
+};
+
+inline void arrowReleaseChild(ArrowArray* a) {
+    delete static_cast<std::shared_ptr<ArrowBoidColumns>*>(a->private_data);
+    delete[] a->buffers;
+    a->release = nullptr;
+}
+
+inline void arrowReleaseArray(ArrowArray* a) {
+    ArrowArrayHolder* h = static_cast<ArrowArrayHolder*>(a->private_data);
+    for (int k = 0; k < ARROW_BOID_COLUMNS; ++k) {
+        if (h->childArrays[k]->release) h->childArrays[k]->release(h->childArrays[k]);
+    }
+    delete h;
+    a->release = nullptr;
+}
+
+inline void arrowReleaseSchema(ArrowSchema* s) {
+    for (int64_t k = 0; k < s->n_children; ++k) {
+        if (s->children[k]->release) s->children[k]->release(s->children[k]);
+        delete s->children[k];
+    }
+    delete[] s->children;
+    s->release = nullptr;
+}
+
+inline void arrowReleaseChildSchema(ArrowSchema* s) { s->release = nullptr; }
+
+inline void exportBoidSchema(ArrowSchema* out) {
+    std::memset(out, 0, sizeof(ArrowSchema));
+    out->format = "+s";
+    out->name = "";
+    out->n_children = ARROW_BOID_COLUMNS;
+    out->children = new ArrowSchema*[ARROW_BOID_COLUMNS];
+    for (int k = 0; k < ARROW_BOID_COLUMNS; ++k) {
+        ArrowSchema* c = new ArrowSchema;
+        std::memset(c, 0, sizeof(ArrowSchema));
+        c->format = k == 0 ? "i" : "f";
+        c->name = ARROW_BOID_NAMES[k];
+        c->flags = ARROW_FLAG_NULLABLE;
+        c->release = &arrowReleaseChildSchema;
+        out->children[k] = c;
+    }
+    out->release = &arrowReleaseSchema;
+}
+
+// Split the boids into columns on `threads` threads (<= 0: all of them)
+inline void exportBoidArray(const std::vector<Boid>& boids, const Tombstones& dead, ArrowArray* out,
+                            int threads = 0) {
+    const int n = static_cast<int>(boids.size());
+    auto cols = std::make_shared<ArrowBoidColumns>();
+    cols->id.resize(n);
+    cols->x.resize(n);
+    cols->y.resize(n);
+    cols->vx.resize(n);
+    cols->vy.resize(n);
+    cols->nulls = dead.deadCount();
+    if (cols->nulls > 0) cols->validity.assign((size_t)(n + 7) / 8, 0);
+
+    int32_t* id = cols->id.data();
+    float* x = cols->x.data();
+    float* y = cols->y.data();
+    float* vx = cols->vx.data();
+    float* vy = cols->vy.data();
+    uint8_t* valid = cols->validity.empty() ? nullptr : cols->validity.data();
+
+    // One pass over the AoS array; blocks of 8 rows so each thread owns
+    // whole validity bytes
+    const int blocks = (n + 7) / 8;
+    if (threads <= 0) threads = omp_get_max_threads();
+    #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+    for (int blk = 0; blk < blocks; ++blk) {
+        uint8_t bits = 0;
+        int end = std::min(n, blk * 8 + 8);
+        for (int i = blk * 8; i < end; ++i) {
+            const Boid& b = boids[i];
+            id[i] = i;
+            x[i] = b.pos.x;
+            y[i] = b.pos.y;
+            vx[i] = b.vel.x;
+            vy[i] = b.vel.y;
+            if (!dead.isDead(i)) bits |= uint8_t(1u << (i & 7));
+        }
+        if (valid) valid[blk] = bits;
+    }
+
+    ArrowArrayHolder* h = new ArrowArrayHolder;
+    h->columns = cols;
+    h->buffers[0] = nullptr; // the struct itself has no nulls
+    h->buffers[1] = nullptr;
+    const void* data[ARROW_BOID_COLUMNS] = { id, x, y, vx, vy };
+    for (int k = 0; k < ARROW_BOID_COLUMNS; ++k) {
+        ArrowArray* c = &h->children[k];
+        std::memset(c, 0, sizeof(ArrowArray));
+        c->length = n;
+        c->null_count = cols->nulls;
+        c->n_buffers = 2;
+        const void** bufs = new const void*[2];
+        bufs[0] = valid;
+        bufs[1] = data[k];
+        c->buffers = bufs;
+        c->release = &arrowReleaseChild;
+        c->private_data = new std::shared_ptr<ArrowBoidColumns>(cols);
+        h->childArrays[k] = c;
+    }
+
+    std::memset(out, 0, sizeof(ArrowArray));
+    out->length = n;
+    out->null_count = 0;
+    out->n_buffers = 1;
+    out->buffers = h->buffers;
+    out->n_children = ARROW_BOID_COLUMNS;
+    out->children = h->childArrays;
+    out->release = &arrowReleaseArray;
+    out->private_data = h;
+}
+
+// A stream of exactly one batch, for consumers that only take streams.
+struct ArrowBoidStream {
+    ArrowArray batch;
+    bool taken = false;
+};
+
+inline int arrowStreamSchema(ArrowArrayStream*, ArrowSchema* out) {
+    exportBoidSchema(out);
+    return 0;
+}
+
+inline int arrowStreamNext(ArrowArrayStream* s, ArrowArray* out) {
+    ArrowBoidStream* p = static_cast<ArrowBoidStream*>(s->private_data);
+    if (p->taken) {
+        std::memset(out, 0, sizeof(ArrowArray)); // end of stream
+    } else {
+        *out = p->batch; // ownership moves to the consumer
+        p->taken = true;
+    }
+    return 0;
+}
+
+inline const char* arrowStreamError(ArrowArrayStream*) { return nullptr; }
+
+inline void arrowReleaseStream(ArrowArrayStream* s) {
+    ArrowBoidStream* p = static_cast<ArrowBoidStream*>(s->private_data);
+    if (!p->taken && p->batch.release) p->batch.release(&p->batch);
+    delete p;
+    s->release = nullptr;
+}
+
+inline void exportBoidStream(const std::vector<Boid>& boids, const Tombstones& dead, ArrowArrayStream* out,
+                             int threads = 0) {
+    ArrowBoidStream* p = new ArrowBoidStream;
+    exportBoidArray(boids, dead, &p->batch, threads);
+    out->get_schema = &arrowStreamSchema;
+    out->get_next = &arrowStreamNext;
+    out->get_last_error = &arrowStreamError;
+    out->release = &arrowReleaseStream;
+    out->private_data = p;
+}
+
+#endif
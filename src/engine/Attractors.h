@@ -0,0 +1,141 @@
+#ifndef ATTRACTORS_H
+#define ATTRACTORS_H
+
+#include "Boid.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+
+struct Attractor {
+    Vector2D pos;
+    float radius;
+    float strength;
+    float capacity;
+};
+
+// Food patches and other points of interest. Attractors are bucketed into
+// a uniform grid whose cell is at least as large as the biggest radius, so
+// a boid only has to look at the 3x3 cells around it no matter how many
+// patches the scenario has.
+//
+// Consumption is accumulated into per-thread slots during the step and
+// reduced once at the end, so the flock loop never writes shared state.
+class AttractorSet {
+    std::vector<Attractor> items;
+    int cols = 0, rows = 0;
+    float cellSize = 1.0f;
+    std::vector<int> cellStart; // CSR offsets, size cols*rows+1
+    std::vector<int> order;     // attractor indices sorted by cell
+    std::vector<float> eaten;   // numThreads * items.size()
+    int numThreads = 0;
+
+    int cellOf(float x, float y) const {
+        int ix = static_cast<int>(x / cellSize);
+        int iy = static_cast<int>(y / cellSize);
+        if (ix < 0) ix = 0; else if (ix >= cols) ix = cols - 1;
+        if (iy < 0) iy = 0; else if (iy >= rows) iy = rows - 1;
+        return iy * cols + ix;
+    }
+
+public:
+    float consumeRate = 0.01f; // capacity removed per feeding boid per step
+
+    bool empty() const { return items.empty(); }
+    int size() const { return static_cast<int>(items.size()); }
+    const Attractor& operator[](int i) const { return items[i]; }
+
+    // data holds count rows of (x, y, radius, strength, capacity)
+    void set(const float* data, int count, float worldW, float worldH) {
+        items.resize(count);
+        float maxRadius = 0.0f;
+        for (int i = 0; i < count; ++i) {
+            const float* r = data + i * 5;
+            items[i].pos = Vector2D(r[0], r[1]);
+            items[i].radius = r[2];
+            items[i].strength = r[3];
+            items[i].capacity = r[4];
+            maxRadius = std::max(maxRadius, r[2]);
+        }
+
+        // Cells no smaller than the largest radius, but never more than
+        // 512 per side so tiny radii don't blow up the index.
+        cellSize = std::max(maxRadius, std::max(worldW, worldH) / 512.0f);
+        cols = std::max(1, static_cast<int>(std::ceil(worldW / cellSize)));
+        rows = std::max(1, static_cast<int>(std::ceil(worldH / cellSize)));
+
+        // Counting sort into buckets
+        cellStart.assign(cols * rows + 1, 0);
+        for (const Attractor& a : items) cellStart[cellOf(a.pos.x, a.pos.y) + 1]++;
+        for (int c = 0; c < cols * rows; ++c) cellStart[c + 1] += cellStart[c];
+        order.resize(count);
+        std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < count; ++i) order[fill[cellOf(items[i].pos.x, items[i].pos.y)]++] = i;
+    }
+
+    void clear() {
+        items.clear();
+        order.clear();
+        cellStart.clear();
+        eaten.clear();
+        cols = rows = 0;
+    }
+
+    // Most attractive live patch whose radius contains the boid, or -1.
+    // The pull falls off linearly towards the edge of the radius.
+    int best(const Boid& b, Vector2D& target) const {
+        int ix = static_cast<int>(b.pos.x / cellSize);
+        int iy = static_cast<int>(b.pos.y / cellSize);
+        int bestIdx = -1;
+        float bestScore = 0.0f;
+
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                int cx = ((ix + dx) % cols + cols) % cols;
+                int cy = ((iy + dy) % rows + rows) % rows;
+                int c = cy * cols + cx;
+
+                for (int k = cellStart[c]; k < cellStart[c + 1]; ++k) {
+                    const Attractor& a = items[order[k]];
+                    if (a.capacity <= 0.0f) continue;
+
+                    Vector2D diff = b.wrappedDiff(b.pos, a.pos);
+                    float dSq = diff.magSq();
+                    if (dSq >= a.radius * a.radius) continue;
+
+                    float score = a.strength * (1.0f - std::sqrt(dSq) / a.radius);
+                    if (score > bestScore) {
+                        bestScore = score;
+                        bestIdx = order[k];
+                        target = b.pos - diff;
+                    }
+                }
+            }
+        }
+        return bestIdx;
+    }
+
+    // Per-thread consumption slots; call before the parallel region.
+    void beginStep(int threads) {
+        numThreads = threads;
+        eaten.assign((size_t)threads * items.size(), 0.0f);
+    }
+
+    float* threadSlots(int tid) { return &eaten[(size_t)tid * items.size()]; }
+
+    // Merge the per-thread slots into the capacities, on `threads` threads
+    // (<= 0: all).
+    void endStep(int threads = 0) {
+        if (threads <= 0) threads = omp_get_max_threads();
+        int m = size();
+        int t = numThreads;
+        #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+        for (int i = 0; i < m; ++i) {
+            float total = 0.0f;
+            for (int k = 0; k < t; ++k) total += eaten[(size_t)k * m + i];
+            items[i].capacity = std::max(0.0f, items[i].capacity - total);
+        }
+    }
+};
+
+#endif
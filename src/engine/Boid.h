@@ -8,13 +8,16 @@
 class Boid {
 public:
     Vector2D pos, vel, accel;
+    Vector2D prevPos; // position before the last update, for render interpolation
     float maxSpeed = 2.5f;  // Reduced from 4.0f
     float maxForce = 0.15f; // Reduced proportionally from 0.2f
     float worldWidth = 1200.0f;
     float worldHeight = 800.0f;
     float wanderAngle;
 
-    Boid(float x, float y) : pos(x, y), vel(0, 0), accel(0, 0) {
+    static constexpr float panicRadiusSq = 10000.0f; // 100^2
+
+    Boid(float x, float y) : pos(x, y), vel(0, 0), accel(0, 0), prevPos(x, y) {
         float angle = ((float)rand() / RAND_MAX) * 6.28318530718f;
         float speed = 1.0f + ((float)rand() / RAND_MAX) * 1.5f; // 1.0-2.5 range
         vel = Vector2D(std::cos(angle) * speed, std::sin(angle) * speed);
@@ -114,7 +117,6 @@ public:
     }
 
     Vector2D flee(Vector2D target) const {
-        float panicRadiusSq = 10000.0f;
         Vector2D diff = pos - target;
         float dSq = diff.magSq();
         if (dSq < panicRadiusSq) {
@@ -126,6 +128,15 @@ public:
         return Vector2D(0, 0);
     }
 
+    // Steer down a scalar gradient (e.g. away from alarm pheromone)
+    Vector2D evade(Vector2D gradient) const {
+        Vector2D away = gradient * -1.0f;
+        away.normalize();
+        Vector2D steer = (away * maxSpeed) - vel;
+        steer.limit(maxForce * 2.0f);
+        return steer;
+    }
+
     void update() {
         vel += accel;
         vel.limit(maxSpeed);
@@ -0,0 +1,71 @@
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Tunable parameters that can be changed through the command queue.
+enum SimParam {
+    PARAM_MAX_SPEED,
+    PARAM_MAX_FORCE,
+    PARAM_FLOW_STRENGTH,
+    PARAM_ALARM_DEPOSIT,
+    PARAM_ALARM_WEIGHT,
+    PARAM_CONSUME_RATE
+};
+
+struct Command {
+    enum Type { SET_PREDATOR, REMOVE_BOIDS, ADD_BOIDS, SET_PARAM };
+
+    Type type;
+    float x = 0, y = 0;       // SET_PREDATOR
+    SimParam param = PARAM_MAX_SPEED;
+    float value = 0;          // SET_PARAM
+    std::vector<int> indices; // REMOVE_BOIDS
+    std::vector<float> rows;  // ADD_BOIDS: (x, y, vx, vy) per boid
+};
+
+// Bounded single-producer/single-consumer ring of commands. The producer
+// (Python) and the consumer (the step loop, at step boundaries) each own
+// one index and only publish it with a release store, so neither side
+// ever takes a lock. Capacity is rounded up to a power of two.
+class CommandQueue {
+    std::vector<Command> ring;
+    size_t mask;
+    std::atomic<size_t> head; // next slot to pop (consumer)
+    std::atomic<size_t> tail; // next slot to fill (producer)
+
+public:
+    explicit CommandQueue(size_t capacity = 1024) : head(0), tail(0) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        ring.resize(cap);
+        mask = cap - 1;
+    }
+
+    // Producer side. Returns false when the queue is full.
+    bool push(Command&& c) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == ring.size()) return false;
+        ring[t & mask] = std::move(c);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the queue is empty.
+    bool pop(Command& c) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        c = std::move(ring[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef DLPACK_H
+#define DLPACK_H
+
+#include "Boid.h"
+#include <vector>
+#include <cstdint>
+
+// Minimal DLPack (legacy, unversioned "dltensor") declarations, ABI
+// compatible with dlpack.h, so state can be handed to NumPy, PyTorch, JAX
+// etc. without copying and without a DLPack dependency.
+
+#ifndef DLPACK_VERSION
+
+typedef enum {
+    kDLCPU = 1
+} DLDeviceType;
+
+typedef struct {
+    DLDeviceType device_type;
+    int32_t device_id;
+} DLDevice;
+
+typedef enum {
+    kDLInt = 0U,
+    kDLUInt = 1U,
+    kDLFloat = 2U
+} DLDataTypeCode;
+
+typedef struct {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+} DLDataType;
+
+typedef struct {
+    void* data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t* shape;
+    int64_t* strides; // in elements
+    uint64_t byte_offset;
+} DLTensor;
+
+typedef struct DLManagedTensor {
+    DLTensor dl_tensor;
+    void* manager_ctx;
+    void (*deleter)(struct DLManagedTensor* self);
+} DLManagedTensor;
+
+#endif
+
+// Owns the shape/strides of an exported view of the boid array. `owner`
+// is whatever keeps the memory alive (the bindings store the Python
+// Simulation object there) and is released by the caller's deleter.
+struct DLBoidTensor {
+    DLManagedTensor managed;
+    int64_t shape[2];
+    int64_t strides[2];
+    void* owner;
+};
+
+// (n, 4) float32 view of x, y, vx, vy, strided over the Boid structs like
+// get_full_state().
+inline DLBoidTensor* makeBoidStateTensor(std::vector<Boid>& boids, void* owner,
+                                         void (*deleter)(DLManagedTensor*)) {
+    static_assert(sizeof(Boid) % sizeof(float) == 0, "Boid must be a whole number of floats");
+    DLBoidTensor* t = new DLBoidTensor;
+    t->shape[0] = static_cast<int64_t>(boids.size());
+    t->shape[1] = 4;
+    t->strides[0] = sizeof(Boid) / sizeof(float);
+    t->strides[1] = 1;
+    t->owner = owner;
+
+    DLTensor& d = t->managed.dl_tensor;
+    d.data = boids.empty() ? nullptr : static_cast<void*>(&boids[0].pos.x);
+    d.device.device_type = kDLCPU;
+    d.device.device_id = 0;
+    d.ndim = 2;
+    d.dtype.code = kDLFloat;
+    d.dtype.bits = 32;
+    d.dtype.lanes = 1;
+    d.shape = t->shape;
+    d.strides = t->strides;
+    d.byte_offset = 0;
+    t->managed.manager_ctx = t;
+    t->managed.deleter = deleter;
+    return t;
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include "Vector2D.h"
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+
+// Environmental current stored as a (rows x cols) grid of velocity vectors
+// laid out row-major as interleaved (vx, vy) pairs, the same layout as a
+// NumPy array of shape (rows, cols, 2). Nodes sit at cell centres and the
+// field wraps like the world does.
+//
+// Frames are double-buffered: Python writes the back buffer with
+// pushFrame() while step() keeps reading the front one, and the swap
+// happens at the next step boundary. Neither side ever waits on the other.
+class FlowField {
+    int cols = 0, rows = 0;
+    float invCellW = 0.0f, invCellH = 0.0f;
+    std::vector<float> front, back;
+    std::atomic<bool> pending;
+
+    // v mod n in [0, n); NaN and values that round up to n map to 0
+    static float wrap(float v, int n) {
+        v = std::fmod(v, static_cast<float>(n));
+        if (v < 0.0f) v += n;
+        return v < n ? v : 0.0f;
+    }
+
+public:
+    FlowField() : pending(false) {}
+
+    bool active() const { return cols > 0 && rows > 0; }
+    int numCols() const { return cols; }
+    int numRows() const { return rows; }
+
+    // Replace the field (and its resolution) immediately. Only call this
+    // between steps.
+    void load(const float* data, int c, int r, float worldW, float worldH) {
+        cols = c;
+        rows = r;
+        invCellW = c / worldW;
+        invCellH = r / worldH;
+        front.assign(data, data + (size_t)c * r * 2);
+        back.assign(front.size(), 0.0f);
+        pending.store(false, std::memory_order_release);
+    }
+
+    void clear() {
+        cols = rows = 0;
+        front.clear();
+        back.clear();
+        pending.store(false, std::memory_order_release);
+    }
+
+    // Stage the next frame. Returns false (and drops the frame) if the
+    // previous one has not been picked up by a step yet.
+    bool pushFrame(const float* data) {
+        if (!active() || pending.load(std::memory_order_acquire)) return false;
+        std::copy(data, data + back.size(), back.begin());
+        pending.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // Called once at the start of each step.
+    void swapIfPending() {
+        if (pending.load(std::memory_order_acquire)) {
+            front.swap(back);
+            pending.store(false, std::memory_order_release);
+        }
+    }
+
+    // Bilinear sample at a world position. Positions any distance outside
+    // the world wrap back in (add_boids doesn't validate them).
+    Vector2D sample(float x, float y) const {
+        float fx = wrap(x * invCellW - 0.5f, cols);
+        float fy = wrap(y * invCellH - 0.5f, rows);
+        float flx = std::floor(fx);
+        float fly = std::floor(fy);
+        float tx = fx - flx;
+        float ty = fy - fly;
+
+        int x0 = static_cast<int>(flx);
+        int y0 = static_cast<int>(fly);
+        int x1 = (x0 + 1 == cols) ? 0 : x0 + 1;
+        int y1 = (y0 + 1 == rows) ? 0 : y0 + 1;
+
+        const float* r0 = &front[(size_t)y0 * cols * 2];
+        const float* r1 = &front[(size_t)y1 * cols * 2];
+
+        float w00 = (1.0f - tx) * (1.0f - ty);
+        float w10 = tx * (1.0f - ty);
+        float w01 = (1.0f - tx) * ty;
+        float w11 = tx * ty;
+
+        return Vector2D(
+            r0[x0 * 2] * w00 + r0[x1 * 2] * w10 + r1[x0 * 2] * w01 + r1[x1 * 2] * w11,
+            r0[x0 * 2 + 1] * w00 + r0[x1 * 2 + 1] * w10 + r1[x0 * 2 + 1] * w01 + r1[x1 * 2 + 1] * w11
+        );
+    }
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+// Fixed-rate pacing with a hybrid sleep/spin wait. The OS sleep is used for
+// most of the gap and only the last stretch is spun (yielding), so timing
+// is precise without burning a core the way pygame's Clock.tick does. The
+// spin window adapts to how much the OS actually oversleeps.
+class FramePacer {
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::duration period;
+    Clock::time_point next;
+    double oversleepUs = 500.0; // running average of sleep overshoot
+
+public:
+    explicit FramePacer(double hz)
+        : period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz))) {}
+
+    void start() { next = Clock::now() + period; }
+
+    // Block until the next tick.
+    void wait() {
+        Clock::time_point now = Clock::now();
+        double spinUs = std::min(2000.0, std::max(50.0, oversleepUs * 1.5 + 50.0));
+        Clock::duration spin = std::chrono::microseconds(static_cast<long long>(spinUs));
+
+        if (next - now > spin) {
+            Clock::time_point wake = next - spin;
+            std::this_thread::sleep_until(wake);
+            double over = std::chrono::duration<double, std::micro>(Clock::now() - wake).count();
+            oversleepUs = 0.9 * oversleepUs + 0.1 * std::max(0.0, over);
+        }
+        while (Clock::now() < next) std::this_thread::yield();
+
+        next += period;
+        // Fell far behind (e.g. a slow callback): resync instead of bursting
+        if (Clock::now() - next > period * 4) next = Clock::now() + period;
+    }
+};
+
+#endif
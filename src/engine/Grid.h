@@ -4,26 +4,52 @@
 #include "Boid.h"
 #include <vector>
 #include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
 
 class Grid {
     int rows, cols;
     float cellSize;
     float width, height;
-    std::vector<std::vector<std::vector<Boid*>>> cells;
+    // Cell (ix, iy) is key ix * rows + iy. Worlds up to DENSE_CELLS cells
+    // keep one bucket per cell, indexed by key. Larger ones (see
+    // RegionPager) only get buckets for occupied cells, found through
+    // `slotOf`, so memory and clearing follow the boids, not the world area.
+    bool sparse;
+    std::vector<std::vector<Boid*>> buckets;
+    std::unordered_map<int64_t, int> slotOf; // sparse only
+    int used = 0;                            // sparse buckets handed out
+    // Buckets filled since the last clear
+    std::vector<int> occupied;
+
+    const std::vector<Boid*>* cell(int cx, int cy) const {
+        const int64_t key = (int64_t)cx * rows + cy;
+        if (!sparse) return &buckets[key];
+        auto it = slotOf.find(key);
+        return it == slotOf.end() ? nullptr : &buckets[it->second];
+    }
 
 public:
-    Grid(float w, float h, float cSize) : width(w), height(h), cellSize(cSize) {
-        cols = static_cast<int>(std::ceil(width / cellSize));
-        rows = static_cast<int>(std::ceil(height / cellSize));
-        cells.resize(cols, std::vector<std::vector<Boid*>>(rows));
+    static const int64_t DENSE_CELLS = 1 << 16;
+
+    Grid(float w, float h, float cSize) : cellSize(cSize), width(w), height(h) {
+        cols = std::max(1, static_cast<int>(std::ceil(width / cellSize)));
+        rows = std::max(1, static_cast<int>(std::ceil(height / cellSize)));
+        sparse = (int64_t)cols * rows > DENSE_CELLS;
+        if (!sparse) buckets.resize((size_t)cols * rows);
     }
 
+    float getCellSize() const { return cellSize; }
+    bool isSparse() const { return sparse; }
+    // Buckets allocated: every cell when dense, the occupied ones when sparse
+    size_t bucketCount() const { return buckets.size(); }
+
     void clear() {
-        for (int x = 0; x < cols; ++x) {
-            for (int y = 0; y < rows; ++y) {
-                cells[x][y].clear();
-            }
-        }
+        for (int b : occupied) buckets[b].clear();
+        occupied.clear();
+        slotOf.clear();
+        used = 0;
     }
 
     void add(Boid* b) {
@@ -34,7 +60,17 @@ public:
         if (ix < 0) ix = 0; if (ix >= cols) ix = cols - 1;
         if (iy < 0) iy = 0; if (iy >= rows) iy = rows - 1;
         
-        cells[ix][iy].push_back(b);
+        const int64_t key = (int64_t)ix * rows + iy;
+        int slot;
+        if (!sparse) {
+            slot = static_cast<int>(key);
+        } else {
+            auto ins = slotOf.emplace(key, used);
+            if (ins.second && ++used > static_cast<int>(buckets.size())) buckets.emplace_back();
+            slot = ins.first->second;
+        }
+        if (buckets[slot].empty()) occupied.push_back(slot);
+        buckets[slot].push_back(b);
     }
 
     int query(float px, float py, Boid** buffer, int maxCount) const {
@@ -49,7 +85,9 @@ public:
                 int cx = (ix + dx + cols) % cols;
                 int cy = (iy + dy + rows) % rows;
                 
-                for (Boid* b : cells[cx][cy]) {
+                const std::vector<Boid*>* c = cell(cx, cy);
+                if (!c) continue;
+                for (Boid* b : *c) {
                     if (count < maxCount) {
                         buffer[count++] = b;
                     } else {
@@ -60,6 +98,34 @@ public:
         }
         return count;
     }
+
+    // Visit every boid in the cells overlapping a square of half-size
+    // radius around (px, py), wrapping at the edges. Each cell is visited
+    // once even when the square is wider than the world.
+    template <typename Visit>
+    void forEachNear(float px, float py, float radius, Visit visit) const {
+        int ix = static_cast<int>(px / cellSize);
+        int iy = static_cast<int>(py / cellSize);
+        if (ix < 0) ix = 0; else if (ix >= cols) ix = cols - 1;
+        if (iy < 0) iy = 0; else if (iy >= rows) iy = rows - 1;
+
+        int span = static_cast<int>(std::ceil(radius / cellSize));
+        int spanX = std::min(span, (cols - 1) / 2);
+        int spanY = std::min(span, (rows - 1) / 2);
+        // Even-sized grids need one extra column/row to cover the far side
+        int extraX = (span > spanX && cols % 2 == 0) ? 1 : 0;
+        int extraY = (span > spanY && rows % 2 == 0) ? 1 : 0;
+
+        for (int dx = -spanX; dx <= spanX + extraX; ++dx) {
+            int cx = ((ix + dx) % cols + cols) % cols;
+            for (int dy = -spanY; dy <= spanY + extraY; ++dy) {
+                int cy = ((iy + dy) % rows + rows) % rows;
+                const std::vector<Boid*>* c = cell(cx, cy);
+                if (!c) continue;
+                for (Boid* b : *c) visit(b);
+            }
+        }
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
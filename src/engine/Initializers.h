@@ -0,0 +1,232 @@
+#ifndef INITIALIZERS_H
+#define INITIALIZERS_H
+
+#include "Vector2D.h"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// Seeded initial layouts. Every random number is a hash of (seed, index),
+// so a layout is the same for a given seed whatever the thread count, and
+// boids can be generated in parallel.
+
+enum SpawnLayout {
+    SPAWN_UNIFORM, // independent uniform positions and headings
+    SPAWN_POISSON, // uniform, but no two boids closer than minDistance
+    SPAWN_SCHOOLS, // compact schools, each heading one way
+    SPAWN_MILL     // a ring of boids circling its center
+};
+
+struct SpawnSpec {
+    SpawnLayout layout = SPAWN_POISSON;
+    uint64_t seed = 1;
+    float speed = 2.0f;
+    // Poisson: minimum spacing; schools: spacing inside a school. 0 picks
+    // one from the density (capped at 20 for schools, inside the
+    // separation radius).
+    float minDistance = 0.0f;
+    int schools = 8;
+    float headingJitter = 0.3f; // radians around the school / ring heading
+    // Mill ring; a negative center means the world center and 0 radii mean
+    // 0.2 / 0.4 of the smaller world side.
+    Vector2D center = Vector2D(-1.0f, -1.0f);
+    float innerRadius = 0.0f;
+    float outerRadius = 0.0f;
+    bool clockwise = false;
+};
+
+inline uint64_t spawnHash(uint64_t seed, uint64_t a, uint64_t b) {
+    // splitmix64 finalizer over the mixed inputs
+    uint64_t z = seed ^ (a * 0x9E3779B97F4A7C15ull) ^ (b * 0xC2B2AE3D27D4EB4Full);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1)
+inline float spawnUniform(uint64_t seed, uint64_t a, uint64_t b) {
+    return static_cast<float>(spawnHash(seed, a, b) >> 40) * (1.0f / 16777216.0f);
+}
+
+inline float spawnWrap(float v, float size) {
+    v = std::fmod(v, size);
+    return v < 0.0f ? v + size : v;
+}
+
+inline void spawnRow(float* row, float x, float y, float heading, float speed) {
+    row[0] = x;
+    row[1] = y;
+    row[2] = std::cos(heading) * speed;
+    row[3] = std::sin(heading) * speed;
+}
+
+static const float SPAWN_TWO_PI = 6.28318530718f;
+static const float SPAWN_GOLDEN_ANGLE = 2.39996322973f;
+
+// Default Poisson spacing for count points: ~0.65 of the hexagonal-packing
+// spacing. Dart throwing saturates around 0.75 of it, leaving headroom.
+inline float poissonSpacing(int count, float w, float h) {
+    return 0.65f * std::sqrt(2.0f * w * h / (1.7320508f * std::max(count, 1)));
+}
+
+// Poisson-disk positions by parallel dart throwing on a background grid.
+// Cells are at least r/sqrt(2) wide, so each holds at most one point and
+// conflicts are within two cells. Cells are coloured by (x mod 3, y mod 3);
+// cells of one colour are three apart and can take darts concurrently.
+// If the rounds don't place `count` points (minDistance too large for the
+// area) the rest are uniform. r <= 0 picks the default spacing; a positive
+// r below half of it is raised to that floor, which still satisfies the
+// request and keeps the background grid near 16 cells per point instead
+// of growing with 1 / r^2.
+inline void poissonPositions(int count, float w, float h, float r, uint64_t seed, std::vector<Vector2D>& out) {
+    out.clear();
+    if (count <= 0) return;
+    const float spacing = poissonSpacing(count, w, h);
+    r = r <= 0.0f ? spacing : std::max(r, 0.5f * spacing);
+    if (!(r < std::max(w, h))) r = std::max(w, h); // also catches NaN
+    const float cellMin = r / 1.41421356f;
+    int64_t cols = std::max<int64_t>(1, static_cast<int64_t>(w / cellMin));
+    int64_t rows = std::max<int64_t>(1, static_cast<int64_t>(h / cellMin));
+    const bool phased = cols >= 3 && rows >= 3;
+    if (phased) {
+        // Multiples of 3 so the colouring also holds across the wrap
+        cols -= cols % 3;
+        rows -= rows % 3;
+    }
+    const float cw = w / cols, ch = h / rows;
+    const float rSq = r * r;
+    const int phases = phased ? 9 : 1;
+    const int64_t step = phased ? 3 : 1;
+
+    std::vector<Vector2D> pts((size_t)cols * rows);
+    std::vector<char> has((size_t)cols * rows, 0);
+    int64_t placed = 0;
+
+    for (int round = 0; round < 32 && placed < count; ++round) {
+        for (int phase = 0; phase < phases; ++phase) {
+            const int64_t px = phase % 3, py = phase / 3;
+            const int64_t pcols = (cols - px + step - 1) / step;
+            const int64_t prows = (rows - py + step - 1) / step;
+            #pragma omp parallel for schedule(static) if(phased)
+            for (int64_t k = 0; k < pcols * prows; ++k) {
+                const int64_t cx = px + (k % pcols) * step, cy = py + (k / pcols) * step;
+                const int64_t c = cy * cols + cx;
+                if (has[c]) continue;
+                Vector2D p((cx + spawnUniform(seed, c, 2 * round)) * cw,
+                           (cy + spawnUniform(seed, c, 2 * round + 1)) * ch);
+                bool ok = true;
+                for (int dy = -2; dy <= 2 && ok; ++dy) {
+                    for (int dx = -2; dx <= 2 && ok; ++dx) {
+                        int64_t n = ((cy + dy + rows) % rows) * cols + (cx + dx + cols) % cols;
+                        if (!has[n]) continue;
+                        float ddx = std::fabs(pts[n].x - p.x), ddy = std::fabs(pts[n].y - p.y);
+                        ddx = std::min(ddx, w - ddx);
+                        ddy = std::min(ddy, h - ddy);
+                        if (ddx * ddx + ddy * ddy < rSq) ok = false;
+                    }
+                }
+                if (ok) {
+                    pts[c] = p;
+                    has[c] = 1;
+                }
+            }
+        }
+        placed = static_cast<int64_t>(std::count(has.begin(), has.end(), 1));
+    }
+
+    std::vector<int64_t> cells;
+    cells.reserve(placed);
+    for (int64_t c = 0; c < cols * rows; ++c) {
+        if (has[c]) cells.push_back(c);
+    }
+    if (placed > count) {
+        // Keep a hash-chosen subset, then restore cell order (neighbors
+        // stay close in memory)
+        std::nth_element(cells.begin(), cells.begin() + count, cells.end(), [seed](int64_t a, int64_t b) {
+            return spawnHash(seed, a, 0xD15C) < spawnHash(seed, b, 0xD15C);
+        });
+        cells.resize(count);
+        std::sort(cells.begin(), cells.end());
+    }
+    out.reserve(count);
+    for (int64_t c : cells) out.push_back(pts[c]);
+    for (int i = static_cast<int>(out.size()); i < count; ++i) {
+        out.push_back(Vector2D(spawnUniform(seed, i, 0xF111) * w, spawnUniform(seed, i, 0xF112) * h));
+    }
+}
+
+// Rows of (x, y, vx, vy) for boids [first, first + n) of a count-boid
+// layout for spec in a w x h world (n < 0: all of them). Every layout but
+// Poisson is a pure function of the index, so a large world can be built
+// in chunks; Poisson places the whole set on every call.
+inline void generateBoids(const SpawnSpec& spec, int count, float w, float h, std::vector<float>& rows, int first = 0,
+                          int n = -1) {
+    count = std::max(count, 0);
+    first = std::min(std::max(first, 0), count);
+    n = n < 0 ? count - first : std::min(n, count - first);
+    rows.assign((size_t)n * 4, 0.0f);
+    if (n <= 0) return;
+    const uint64_t seed = spec.seed;
+
+    switch (spec.layout) {
+    case SPAWN_UNIFORM:
+    case SPAWN_POISSON: {
+        std::vector<Vector2D> pos;
+        if (spec.layout == SPAWN_POISSON) {
+            poissonPositions(count, w, h, spec.minDistance, seed, pos);
+        }
+        #pragma omp parallel for schedule(static)
+        for (int k = 0; k < n; ++k) {
+            const int i = first + k;
+            float x = pos.empty() ? spawnUniform(seed, i, 0) * w : pos[i].x;
+            float y = pos.empty() ? spawnUniform(seed, i, 1) * h : pos[i].y;
+            spawnRow(&rows[(size_t)k * 4], x, y, spawnUniform(seed, i, 2) * SPAWN_TWO_PI,
+                     spec.speed * (0.75f + 0.5f * spawnUniform(seed, i, 3)));
+        }
+        break;
+    }
+    case SPAWN_SCHOOLS: {
+        // School centers are themselves Poisson-disk samples; members fill
+        // a sunflower (Vogel) spiral, evenly spaced without overlaps.
+        const int schools = std::max(1, std::min(spec.schools, count));
+        const float spacing = spec.minDistance > 0.0f ? spec.minDistance : std::min(20.0f, poissonSpacing(count, w, h));
+        const float schoolRadius = spacing * 0.55f * std::sqrt(static_cast<float>(count / schools + 1));
+        std::vector<Vector2D> centers;
+        poissonPositions(schools, w, h, 2.0f * schoolRadius + spacing, seed ^ 0x5C400u, centers);
+        #pragma omp parallel for schedule(static)
+        for (int k = 0; k < n; ++k) {
+            const int i = first + k;
+            const int s = i % schools, m = i / schools;
+            const float heading = spawnUniform(seed, s, 0x5C401) * SPAWN_TWO_PI;
+            const float rad = spacing * 0.55f * std::sqrt(m + 0.5f);
+            const float a = m * SPAWN_GOLDEN_ANGLE;
+            const float jitter = (spawnUniform(seed, i, 4) - 0.5f) * 2.0f * spec.headingJitter;
+            spawnRow(&rows[(size_t)k * 4], spawnWrap(centers[s].x + rad * std::cos(a), w),
+                     spawnWrap(centers[s].y + rad * std::sin(a), h), heading + jitter,
+                     spec.speed * (0.9f + 0.2f * spawnUniform(seed, i, 5)));
+        }
+        break;
+    }
+    case SPAWN_MILL: {
+        const float side = std::min(w, h);
+        const float outer = spec.outerRadius > 0.0f ? spec.outerRadius : 0.4f * side;
+        const float inner = spec.innerRadius > 0.0f ? std::min(spec.innerRadius, outer) : 0.5f * outer;
+        const Vector2D c = spec.center.x < 0.0f || spec.center.y < 0.0f ? Vector2D(w / 2, h / 2) : spec.center;
+        const float turn = spec.clockwise ? -1.0f : 1.0f;
+        #pragma omp parallel for schedule(static)
+        for (int k = 0; k < n; ++k) {
+            // Equal-area radii over the annulus, golden-angle spread
+            const int i = first + k;
+            const float rad = std::sqrt(inner * inner + (outer * outer - inner * inner) * (i + 0.5f) / count);
+            const float a = i * SPAWN_GOLDEN_ANGLE;
+            const float jitter = (spawnUniform(seed, i, 4) - 0.5f) * 2.0f * spec.headingJitter;
+            spawnRow(&rows[(size_t)k * 4], spawnWrap(c.x + rad * std::cos(a), w), spawnWrap(c.y + rad * std::sin(a), h),
+                     a + turn * 1.57079633f + jitter, spec.speed * (0.9f + 0.2f * spawnUniform(seed, i, 5)));
+        }
+        break;
+    }
+    }
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef NEIGHBORGRAPH_H
+#define NEIGHBORGRAPH_H
+
+#include "Boid.h"
+#include "Grid.h"
+#include "Tombstones.h"
+#include <vector>
+#include <cstdint>
+#include <atomic>
+
+// Calls visit(j, distance) for every neighbour j of boid i within radius.
+// With flockNeighbors the candidates are exactly the (at most 64) boids
+// that Boid::flock sees from Grid::query, filtered by radius; otherwise
+// every boid within radius is reported.
+template <typename Visit>
+inline void forEachNeighbor(const std::vector<Boid>& boids, const Grid& grid, int i,
+                            float radius, bool flockNeighbors, Visit visit) {
+    const Boid& b = boids[i];
+    const Boid* base = boids.data();
+    const float rSq = radius * radius;
+
+    if (flockNeighbors) {
+        Boid* buffer[64];
+        int found = grid.query(b.pos.x, b.pos.y, buffer, 64);
+        for (int k = 0; k < found; ++k) {
+            const Boid* o = buffer[k];
+            if (o == &b) continue;
+            float dSq = b.wrappedDiff(b.pos, o->pos).magSq();
+            if (dSq < rSq) visit(static_cast<int>(o - base), std::sqrt(dSq));
+        }
+    } else {
+        grid.forEachNear(b.pos.x, b.pos.y, radius, [&](const Boid* o) {
+            if (o == &b) return;
+            float dSq = b.wrappedDiff(b.pos, o->pos).magSq();
+            if (dSq < rSq) visit(static_cast<int>(o - base), std::sqrt(dSq));
+        });
+    }
+}
+
+// Build the neighbour graph in CSR form: the neighbours of boid i are
+// indices[indptr[i] .. indptr[i+1]), with matching edge lengths in dists
+// if it is non-null. Rows are counted in parallel, prefix-summed, then
+// filled in parallel.
+//
+// Returns the number of edges. indptr (n + 1 entries) is always written;
+// if the edge count exceeds capacity, indices/dists are left untouched so
+// the caller can grow its buffers and call again. Dead rows (the grid
+// holds only live boids) get no edges in either direction.
+inline int64_t buildNeighborCSR(const std::vector<Boid>& boids, const Tombstones& dead, const Grid& grid,
+                                float radius, bool flockNeighbors,
+                                int64_t* indptr, int32_t* indices, float* dists,
+                                int64_t capacity) {
+    int n = static_cast<int>(boids.size());
+
+    indptr[0] = 0;
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; ++i) {
+        int64_t count = 0;
+        if (!dead.isDead(i)) forEachNeighbor(boids, grid, i, radius, flockNeighbors, [&](int, float) { ++count; });
+        indptr[i + 1] = count;
+    }
+
+    for (int i = 0; i < n; ++i) indptr[i + 1] += indptr[i];
+
+    int64_t nnz = indptr[n];
+    if (nnz > capacity) return nnz;
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; ++i) {
+        int64_t k = indptr[i];
+        if (dead.isDead(i)) continue;
+        forEachNeighbor(boids, grid, i, radius, flockNeighbors, [&](int j, float d) {
+            indices[k] = j;
+            if (dists) dists[k] = d;
+            ++k;
+        });
+    }
+    return nnz;
+}
+
+// Reverse every edge of a CSR graph (counting sort by target). Used when
+// the graph is directed, e.g. the capped neighbour lists flock() sees.
+inline void transposeCSR(int n, const int64_t* indptr, const int32_t* indices,
+                         std::vector<int64_t>& outIndptr, std::vector<int32_t>& outIndices) {
+    int64_t nnz = indptr[n];
+    outIndptr.assign(n + 1, 0);
+    outIndices.resize(nnz);
+    for (int64_t k = 0; k < nnz; ++k) outIndptr[indices[k] + 1]++;
+    for (int i = 0; i < n; ++i) outIndptr[i + 1] += outIndptr[i];
+    std::vector<int64_t> fill(outIndptr.begin(), outIndptr.end() - 1);
+    for (int u = 0; u < n; ++u) {
+        for (int64_t k = indptr[u]; k < indptr[u + 1]; ++k) outIndices[fill[indices[k]]++] = u;
+    }
+}
+
+// Level-synchronous BFS from a set of seed boids over a CSR graph. Each
+// frontier is expanded in parallel; boids are claimed with a CAS so every
+// boid joins exactly one frontier. Writes the hop distance of every boid
+// to hops (-1 if unreached within maxHops, maxHops < 0 for no limit) and
+// returns the size of each frontier, starting with the seeds at hop 0.
+inline std::vector<int64_t> frontierBFS(int n, const int64_t* indptr, const int32_t* indices,
+                                        const std::vector<int>& seeds, int maxHops,
+                                        int32_t* hops) {
+    std::vector<std::atomic<int32_t>> level(n);
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; ++i) level[i].store(-1, std::memory_order_relaxed);
+
+    std::vector<int> frontier;
+    for (int s : seeds) {
+        if (s < 0 || s >= n || level[s].load(std::memory_order_relaxed) == 0) continue;
+        level[s].store(0, std::memory_order_relaxed);
+        frontier.push_back(s);
+    }
+
+    std::vector<int64_t> sizes;
+    std::vector<int> next;
+    int hop = 0;
+    while (!frontier.empty()) {
+        sizes.push_back(static_cast<int64_t>(frontier.size()));
+        if (maxHops >= 0 && hop >= maxHops) break;
+
+        next.clear();
+        int m = static_cast<int>(frontier.size());
+        #pragma omp parallel
+        {
+            std::vector<int> local;
+
+            #pragma omp for schedule(dynamic, 64)
+            for (int f = 0; f < m; ++f) {
+                int u = frontier[f];
+                for (int64_t k = indptr[u]; k < indptr[u + 1]; ++k) {
+                    int v = indices[k];
+                    int32_t unseen = -1;
+                    if (level[v].load(std::memory_order_relaxed) == -1 &&
+                        level[v].compare_exchange_strong(unseen, hop + 1, std::memory_order_relaxed)) {
+                        local.push_back(v);
+                    }
+                }
+            }
+
+            #pragma omp critical
+            next.insert(next.end(), local.begin(), local.end());
+        }
+
+        frontier.swap(next);
+        ++hop;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; ++i) hops[i] = level[i].load(std::memory_order_relaxed);
+
+    return sizes;
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef OBSTACLES_H
+#define OBSTACLES_H
+
+#include "Boid.h"
+#include <vector>
+#include <cmath>
+
+struct Obstacle {
+    Vector2D pos;
+    float radius;
+};
+
+// Solid circular obstacles (rocks, pillars). Boids steer away once within
+// `margin` of the rim, harder the closer they are, and any boid that still
+// ends a step inside one is put back on its rim. Meant for a handful of
+// obstacles per world, so they are checked linearly.
+class ObstacleSet {
+    std::vector<Obstacle> items;
+
+public:
+    float margin = 30.0f;
+
+    bool empty() const { return items.empty(); }
+    int size() const { return static_cast<int>(items.size()); }
+    const Obstacle& operator[](int i) const { return items[i]; }
+
+    // data holds count rows of (x, y, radius)
+    void set(const float* data, int count) {
+        items.resize(count);
+        for (int i = 0; i < count; ++i) {
+            items[i].pos = Vector2D(data[i * 3], data[i * 3 + 1]);
+            items[i].radius = data[i * 3 + 2];
+        }
+    }
+
+    void clear() { items.clear(); }
+
+    Vector2D avoid(const Boid& b) const {
+        Vector2D force(0, 0);
+        for (const Obstacle& o : items) {
+            Vector2D away = b.wrappedDiff(b.pos, o.pos);
+            float reach = o.radius + margin;
+            float dSq = away.magSq();
+            if (dSq >= reach * reach || dSq == 0.0f) continue;
+            float closeness = 1.0f - (std::sqrt(dSq) - o.radius) / margin; // 0 at reach, 1 on the rim
+            force += b.evade(away * -1.0f) * std::min(closeness, 1.0f);
+        }
+        return force;
+    }
+
+    void resolve(Boid& b) const {
+        for (const Obstacle& o : items) {
+            Vector2D away = b.wrappedDiff(b.pos, o.pos);
+            float dSq = away.magSq();
+            if (dSq >= o.radius * o.radius) continue;
+            if (dSq == 0.0f) away = Vector2D(1.0f, 0.0f);
+            away.normalize();
+            b.pos += away * (o.radius - std::sqrt(dSq));
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef REGIONPAGER_H
+#define REGIONPAGER_H
+
+#include "Boid.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Out-of-core storage for very large worlds. The world is cut into square
+// regions; a region is resident while a focus point (the predator or a
+// camera) is within activeRadius of it, and otherwise its boids live in a
+// file of raw Boid records in `directory` and are frozen. Residency has a
+// margin of one region so boids near a border don't flip back and forth.
+//
+// Records are appended and read back through short-lived mappings, so a
+// paged-out region costs no RAM beyond what the page cache chooses to
+// keep. Windows falls back to stdio. Boids added while paging is on go
+// straight to their region's file if it is paged out, so a world larger
+// than memory can be created by streaming it in after enable.
+class RegionPager {
+    std::string dir;
+    int cols = 0, rows = 0;
+    float size = 0.0f;
+    float activeRadius = 0.0f;
+    std::vector<char> resident;
+    std::vector<uint32_t> stored; // records on disk per region
+    uint64_t failedReads = 0;
+
+    std::string path(int r) const { return dir + "/region_" + std::to_string(r) + ".bin"; }
+
+    bool writeRecords(int r, const Boid* data, uint32_t count) {
+        const size_t bytes = (size_t)count * sizeof(Boid);
+        const size_t old = (size_t)stored[r] * sizeof(Boid);
+#ifndef _WIN32
+        int fd = ::open(path(r).c_str(), O_RDWR | O_CREAT, 0600);
+        if (fd < 0) return false;
+        if (ftruncate(fd, static_cast<off_t>(old + bytes)) != 0) {
+            ::close(fd);
+            return false;
+        }
+        // Map only the pages being appended to
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t off = old & ~(page - 1);
+        void* p = mmap(nullptr, old + bytes - off, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(off));
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        std::memcpy(static_cast<uint8_t*>(p) + (old - off), data, bytes);
+        munmap(p, old + bytes - off);
+#else
+        FILE* f = std::fopen(path(r).c_str(), "ab");
+        if (!f) return false;
+        bool ok = std::fwrite(data, 1, bytes, f) == bytes;
+        std::fclose(f);
+        if (!ok) return false;
+#endif
+        stored[r] += count;
+        return true;
+    }
+
+    bool readRecords(int r, std::vector<Boid>& out) {
+        const size_t bytes = (size_t)stored[r] * sizeof(Boid);
+        const size_t first = out.size();
+        out.resize(first + stored[r], Boid(0, 0));
+#ifndef _WIN32
+        int fd = ::open(path(r).c_str(), O_RDWR);
+        void* p = fd < 0 ? MAP_FAILED : mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            if (fd >= 0) ::close(fd);
+            out.erase(out.begin() + first, out.end());
+            return false;
+        }
+        std::memcpy(static_cast<void*>(out.data() + first), p, bytes);
+        munmap(p, bytes);
+        if (ftruncate(fd, 0) != 0) {}
+        ::close(fd);
+#else
+        FILE* f = std::fopen(path(r).c_str(), "rb");
+        bool ok = f && std::fread(static_cast<void*>(out.data() + first), 1, bytes, f) == bytes;
+        if (f) std::fclose(f);
+        if (!ok) {
+            out.erase(out.begin() + first, out.end());
+            return false;
+        }
+        std::remove(path(r).c_str());
+#endif
+        stored[r] = 0;
+        return true;
+    }
+
+public:
+    ~RegionPager() { stop(); }
+
+    bool active() const { return cols > 0; }
+    int numRegions() const { return cols * rows; }
+    bool isResident(int r) const { return resident[r] != 0; }
+
+    uint64_t pagedCount() const {
+        uint64_t total = 0;
+        for (uint32_t c : stored) total += c;
+        return total;
+    }
+
+    int residentRegions() const {
+        return static_cast<int>(std::count(resident.begin(), resident.end(), 1));
+    }
+
+    // Everything starts resident; the first paging pass moves the rest out.
+    bool start(const std::string& directory, float worldW, float worldH, float regionSize, float radius) {
+        stop();
+        if (regionSize <= 0.0f) return false;
+        dir = directory;
+        size = regionSize;
+        activeRadius = radius;
+        cols = std::max(1, static_cast<int>(std::ceil(worldW / size)));
+        rows = std::max(1, static_cast<int>(std::ceil(worldH / size)));
+        resident.assign((size_t)cols * rows, 1);
+        stored.assign((size_t)cols * rows, 0);
+        failedReads = 0;
+        return true;
+    }
+
+    // Forget the files. The caller pages everything in first.
+    void stop() {
+        for (size_t r = 0; r < stored.size(); ++r) std::remove(path(static_cast<int>(r)).c_str());
+        cols = rows = 0;
+        resident.clear();
+        stored.clear();
+    }
+
+    int regionOf(const Vector2D& p) const {
+        int cx = std::min(std::max(static_cast<int>(p.x / size), 0), cols - 1);
+        int cy = std::min(std::max(static_cast<int>(p.y / size), 0), rows - 1);
+        return cy * cols + cx;
+    }
+
+    // Which regions should be resident for these focus points. A region
+    // stays resident (but does not become resident) within one extra region
+    // of the radius.
+    void wanted(const std::vector<Vector2D>& focus, std::vector<char>& want) const {
+        want.assign(resident.size(), 0);
+        for (int r = 0; r < cols * rows; ++r) {
+            float x0 = (r % cols) * size, y0 = (r / cols) * size;
+            float reach = resident[r] ? activeRadius + size : activeRadius;
+            for (const Vector2D& f : focus) {
+                // Distance from the focus to the region's rectangle
+                float dx = std::max(std::max(x0 - f.x, f.x - (x0 + size)), 0.0f);
+                float dy = std::max(std::max(y0 - f.y, f.y - (y0 + size)), 0.0f);
+                if (dx * dx + dy * dy <= reach * reach) {
+                    want[r] = 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Mark a region paged out, appending boids to its file. On failure the
+    // region (and the boids) stay resident.
+    bool pageOut(int r, const std::vector<Boid>& group) {
+        if (!group.empty() && !writeRecords(r, group.data(), static_cast<uint32_t>(group.size()))) return false;
+        resident[r] = 0;
+        return true;
+    }
+
+    // Mark a region resident, appending its stored boids to `out`. If they
+    // can't be read back the region stays paged out with its file intact,
+    // and the failure is counted in readFailures().
+    bool pageIn(int r, std::vector<Boid>& out) {
+        if (stored[r] != 0 && !readRecords(r, out)) {
+            ++failedReads;
+            return false;
+        }
+        resident[r] = 1;
+        return true;
+    }
+
+    uint64_t readFailures() const { return failedReads; }
+};
+
+#endif
@@ -0,0 +1,277 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include "Tombstones.h"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+// Rolling in-memory history of recent simulation states for instant replay.
+//
+// step() only copies the raw boid array and its tombstone bitmap into a
+// staging slot; a background thread does the compression. Frames are stored as 32-bit words XORed
+// against a reference (the previous frame for deltas, the previous boid's
+// record for keyframes) and packed with a 2-bit size tag per word, so
+// unchanged fields cost two bits and slowly changing floats two or three
+// bytes. The encoding is lossless, so the boid records and which of them
+// are removed come back exactly. Nothing else is kept: attractor capacities, the alarm field, flow
+// buffers and trails are not part of a frame.
+//
+// The history is bounded by a byte budget; the oldest keyframe and its
+// deltas are evicted together. The newest group is never evicted: if it
+// alone outgrows the budget the next frame is forced to be a keyframe.
+class RewindBuffer {
+    struct Frame {
+        uint64_t step;
+        int count;
+        bool key;
+        std::vector<uint8_t> tags;  // 4 tags per byte
+        std::vector<uint8_t> bytes; // low-order bytes of each XOR word
+        size_t size() const { return tags.size() + bytes.size() + sizeof(Frame); }
+    };
+
+    struct Staged {
+        uint64_t step;
+        int count;
+        std::vector<uint32_t> words;
+    };
+
+    static const int MAX_STAGED = 2;
+
+    size_t maxBytes = 0;
+    int keyInterval = 60;
+    size_t recordWords = 0;
+
+    std::deque<Frame> frames;
+    size_t totalBytes = 0;
+
+    // Worker state (guarded by mtx)
+    std::deque<Staged> staged;
+    std::vector<std::vector<uint32_t>> spare;
+    std::vector<uint32_t> lastRaw;
+    uint64_t lastStep = 0;
+    int lastCount = -1;
+    int sinceKey = 0;
+    bool busy = false;
+    bool stopping = false;
+
+    // Records followed by the tombstone bitmap
+    static size_t frameWords(int count, size_t stride) {
+        return (size_t)count * stride + Tombstones::bytesFor(count) / sizeof(uint32_t);
+    }
+
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable wake, idle;
+
+    static void encode(const uint32_t* cur, const uint32_t* prev, size_t words, size_t stride, Frame& f) {
+        f.tags.assign((words + 3) / 4, 0);
+        f.bytes.clear();
+        f.bytes.reserve(words * 3);
+        for (size_t j = 0; j < words; ++j) {
+            uint32_t ref = prev ? prev[j] : (j >= stride ? cur[j - stride] : 0u);
+            uint32_t x = cur[j] ^ ref;
+            uint8_t tag = x == 0 ? 0 : x < (1u << 16) ? 1 : x < (1u << 24) ? 2 : 3;
+            f.tags[j >> 2] |= static_cast<uint8_t>(tag << ((j & 3) * 2));
+            int nbytes = tag == 0 ? 0 : tag + 1;
+            for (int b = 0; b < nbytes; ++b) f.bytes.push_back(static_cast<uint8_t>(x >> (8 * b)));
+        }
+        f.bytes.shrink_to_fit();
+    }
+
+    // Inverse of encode; out holds the previous frame on entry for deltas.
+    static void decode(const Frame& f, size_t stride, std::vector<uint32_t>& out) {
+        size_t words = frameWords(f.count, stride);
+        if (f.key) out.assign(words, 0u);
+        const uint8_t* p = f.bytes.data();
+        for (size_t j = 0; j < words; ++j) {
+            int tag = (f.tags[j >> 2] >> ((j & 3) * 2)) & 3;
+            int nbytes = tag == 0 ? 0 : tag + 1;
+            uint32_t x = 0;
+            for (int b = 0; b < nbytes; ++b) x |= static_cast<uint32_t>(*p++) << (8 * b);
+            uint32_t ref = f.key ? (j >= stride ? out[j - stride] : 0u) : out[j];
+            out[j] = x ^ ref;
+        }
+    }
+
+    void evict() {
+        while (totalBytes > maxBytes && frames.size() > 1) {
+            auto next = std::find_if(frames.begin() + 1, frames.end(), [](const Frame& f) { return f.key; });
+            if (next == frames.end()) {
+                // Only the newest group is left; evicting it would leave
+                // later deltas with nothing to chain from. Close it instead
+                // so the next frame starts a group and this one can go.
+                lastCount = -1;
+                break;
+            }
+            // Deltas are useless without their keyframe
+            do {
+                totalBytes -= frames.front().size();
+                frames.pop_front();
+            } while (!frames.front().key);
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || !staged.empty(); });
+            if (staged.empty()) break;
+
+            Staged s = std::move(staged.front());
+            staged.pop_front();
+            busy = true;
+            bool key = !(s.count == lastCount && s.step == lastStep + 1 && sinceKey < keyInterval);
+            lock.unlock();
+
+            Frame f;
+            f.step = s.step;
+            f.count = s.count;
+            f.key = key;
+            encode(s.words.data(), key ? nullptr : lastRaw.data(), s.words.size(), recordWords, f);
+
+            lock.lock();
+            lastRaw.swap(s.words);
+            spare.push_back(std::move(s.words));
+            lastStep = f.step;
+            lastCount = f.count;
+            sinceKey = key ? 1 : sinceKey + 1;
+            totalBytes += f.size();
+            frames.push_back(std::move(f));
+            evict();
+            busy = false;
+            idle.notify_all();
+        }
+    }
+
+    void flushLocked(std::unique_lock<std::mutex>& lock) {
+        idle.wait(lock, [this] { return staged.empty() && !busy; });
+    }
+
+public:
+    ~RewindBuffer() { stop(); }
+
+    // Worst-case size of a keyframe of count records (every word
+    // incompressible); budgets below this can't hold even one frame.
+    static size_t keyframeBytes(int count, size_t bytesPerRecord) {
+        size_t words = frameWords(std::max(count, 0), bytesPerRecord / sizeof(uint32_t));
+        return sizeof(Frame) + (words + 3) / 4 + words * sizeof(uint32_t);
+    }
+
+    bool active() const { return worker.joinable(); }
+
+    void start(size_t budgetBytes, int keyframeInterval, size_t bytesPerRecord) {
+        stop();
+        maxBytes = budgetBytes;
+        keyInterval = keyframeInterval > 0 ? keyframeInterval : 1;
+        recordWords = bytesPerRecord / sizeof(uint32_t);
+        stopping = false;
+        lastCount = -1;
+        worker = std::thread(&RewindBuffer::run, this);
+    }
+
+    void stop() {
+        if (!worker.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+        frames.clear();
+        staged.clear();
+        spare.clear();
+        lastRaw.clear();
+        totalBytes = 0;
+    }
+
+    // Hand a copy of the raw state to the worker. If it has fallen behind
+    // the frame is dropped rather than stalling the step; the gap simply
+    // forces the next frame to be a keyframe.
+    void capture(uint64_t step, const void* data, int count, const Tombstones& dead) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (staged.size() >= MAX_STAGED) return;
+
+        Staged s;
+        s.step = step;
+        s.count = count;
+        if (!spare.empty()) {
+            s.words.swap(spare.back());
+            spare.pop_back();
+        }
+        lock.unlock();
+
+        const size_t recordBytes = (size_t)count * recordWords * sizeof(uint32_t);
+        s.words.resize(frameWords(count, recordWords));
+        if (count > 0) {
+            std::memcpy(s.words.data(), data, recordBytes);
+            std::memcpy(reinterpret_cast<uint8_t*>(s.words.data()) + recordBytes, dead.bits(), Tombstones::bytesFor(count));
+        }
+
+        lock.lock();
+        staged.push_back(std::move(s));
+        lock.unlock();
+        wake.notify_one();
+    }
+
+    // Decode the newest retained frame at or before target into out (raw
+    // records, then the tombstone bitmap) and drop everything after it. Returns false if the
+    // history does not reach back that far.
+    bool restore(uint64_t target, std::vector<uint32_t>& out, int& count, uint64_t& step) {
+        std::unique_lock<std::mutex> lock(mtx);
+        flushLocked(lock);
+
+        int idx = static_cast<int>(frames.size()) - 1;
+        while (idx >= 0 && frames[idx].step > target) --idx;
+        if (idx < 0) return false;
+
+        int k = idx;
+        while (k > 0 && !frames[k].key) --k;
+        if (!frames[k].key) return false;
+
+        for (int i = k; i <= idx; ++i) decode(frames[i], recordWords, out);
+        count = frames[idx].count;
+        step = frames[idx].step;
+
+        while (static_cast<int>(frames.size()) > idx + 1) {
+            totalBytes -= frames.back().size();
+            frames.pop_back();
+        }
+
+        // Continue the delta chain from the restored state
+        lastRaw = out;
+        lastStep = step;
+        lastCount = count;
+        sinceKey = idx - k + 1;
+        return true;
+    }
+
+    // Wait until every captured frame has been encoded.
+    void flush() {
+        std::unique_lock<std::mutex> lock(mtx);
+        flushLocked(lock);
+    }
+
+    size_t bytesUsed() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return totalBytes;
+    }
+
+    size_t frameCount() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return frames.size();
+    }
+
+    // Oldest step still restorable
+    uint64_t oldestStep() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return frames.empty() ? 0 : frames.front().step;
+    }
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef SCALARFIELD_H
+#define SCALARFIELD_H
+
+#include "Vector2D.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+
+// Wrapping scalar grid (alarm pheromone) that diffuses and decays every
+// step. Values are stored row-major as a (rows x cols) float array and
+// sampled bilinearly between cell centres.
+class ScalarField {
+    int cols = 0, rows = 0;
+    float cellW = 1.0f, cellH = 1.0f;
+    std::vector<float> cur, next;
+
+    // Tile shape for the stencil. A strip of 1024 columns keeps the three
+    // rows the stencil touches (12 KB) resident in L1 while a block of rows
+    // is swept, and gives each thread a few hundred KB of work.
+    static const int TILE_COLS = 1024;
+    static const int TILE_ROWS = 64;
+
+public:
+    static constexpr float MAX_DIFFUSION = 0.25f; // the explicit stencil is unstable above this
+
+    float diffusion = 0.2f; // fraction of the Laplacian mixed in per step, in [0, MAX_DIFFUSION]
+    float decay = 0.02f;    // fraction lost per step
+
+    bool active() const { return cols > 0 && rows > 0; }
+    int numCols() const { return cols; }
+    int numRows() const { return rows; }
+    const float* data() const { return cur.data(); }
+
+    // Returns false (and leaves the field as it was) unless both sizes are
+    // positive.
+    bool resize(int c, int r, float worldW, float worldH) {
+        if (c <= 0 || r <= 0) return false;
+        cols = c;
+        rows = r;
+        cellW = worldW / c;
+        cellH = worldH / r;
+        cur.assign((size_t)c * r, 0.0f);
+        next.assign(cur.size(), 0.0f);
+        return true;
+    }
+
+    void clear() {
+        cols = rows = 0;
+        cur.clear();
+        next.clear();
+    }
+
+    int cellIndex(float x, float y) const {
+        int ix = static_cast<int>(x / cellW);
+        int iy = static_cast<int>(y / cellH);
+        if (ix < 0) ix = 0; else if (ix >= cols) ix = cols - 1;
+        if (iy < 0) iy = 0; else if (iy >= rows) iy = rows - 1;
+        return iy * cols + ix;
+    }
+
+    void deposit(int cell, float amount) { cur[cell] += amount; }
+
+    // Bilinear value at a world position; also returns the gradient of the
+    // interpolant (per world unit) so callers get both in one lookup.
+    float sample(float x, float y, Vector2D& grad) const {
+        float fx = x / cellW - 0.5f;
+        float fy = y / cellH - 0.5f;
+        float flx = std::floor(fx);
+        float fly = std::floor(fy);
+        float tx = fx - flx;
+        float ty = fy - fly;
+
+        int x0 = static_cast<int>(flx);
+        int y0 = static_cast<int>(fly);
+        if (x0 < 0) x0 += cols; else if (x0 >= cols) x0 -= cols;
+        if (y0 < 0) y0 += rows; else if (y0 >= rows) y0 -= rows;
+        int x1 = (x0 + 1 == cols) ? 0 : x0 + 1;
+        int y1 = (y0 + 1 == rows) ? 0 : y0 + 1;
+
+        float v00 = cur[(size_t)y0 * cols + x0];
+        float v10 = cur[(size_t)y0 * cols + x1];
+        float v01 = cur[(size_t)y1 * cols + x0];
+        float v11 = cur[(size_t)y1 * cols + x1];
+
+        grad = Vector2D(((v10 - v00) * (1.0f - ty) + (v11 - v01) * ty) / cellW,
+                        ((v01 - v00) * (1.0f - tx) + (v11 - v10) * tx) / cellH);
+
+        return (v00 * (1.0f - tx) + v10 * tx) * (1.0f - ty) +
+               (v01 * (1.0f - tx) + v11 * tx) * ty;
+    }
+
+    // One explicit diffusion + decay step with a 5-point stencil, on
+    // `threads` threads (0 = OpenMP default).
+    void diffuse(int threads = 0) {
+        if (threads <= 0) threads = omp_get_max_threads();
+        const int tilesX = (cols + TILE_COLS - 1) / TILE_COLS;
+        const int tilesY = (rows + TILE_ROWS - 1) / TILE_ROWS;
+        const int tiles = tilesX * tilesY;
+        const float keep = 1.0f - decay;
+        const float centre = (1.0f - 4.0f * diffusion) * keep;
+        const float side = diffusion * keep;
+        const int c = cols;
+        const int r = rows;
+        const float* src = cur.data();
+        float* dst = next.data();
+
+        #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+        for (int t = 0; t < tiles; ++t) {
+            int x0 = (t % tilesX) * TILE_COLS;
+            int x1 = std::min(x0 + TILE_COLS, c);
+            int y0 = (t / tilesX) * TILE_ROWS;
+            int y1 = std::min(y0 + TILE_ROWS, r);
+
+            for (int y = y0; y < y1; ++y) {
+                const float* up = src + (size_t)((y + r - 1) % r) * c;
+                const float* mid = src + (size_t)y * c;
+                const float* dn = src + (size_t)((y + 1) % r) * c;
+                float* out = dst + (size_t)y * c;
+
+                // Interior columns: no wrap, unit stride, vectorizes cleanly
+                int lo = std::max(x0, 1);
+                int hi = std::min(x1, c - 1);
+                for (int x = lo; x < hi; ++x) {
+                    out[x] = centre * mid[x] + side * (up[x] + dn[x] + mid[x - 1] + mid[x + 1]);
+                }
+
+                // Wrapped edge columns
+                if (x0 == 0) {
+                    int xl = c - 1, xr = (c > 1) ? 1 : 0;
+                    out[0] = centre * mid[0] + side * (up[0] + dn[0] + mid[xl] + mid[xr]);
+                }
+                if (x1 == c && c > 1) {
+                    int x = c - 1;
+                    out[x] = centre * mid[x] + side * (up[x] + dn[x] + mid[x - 1] + mid[0]);
+                }
+            }
+        }
+
+        cur.swap(next);
+    }
+};
+
+#endif
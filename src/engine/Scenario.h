@@ -0,0 +1,342 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include "simulation.h"
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+
+// Declarative experiment description, read from an INI-style file:
+//
+//   [world]       width, height, seed, threads
+//   [run]         steps
+//   [population]  count, layout, seed, speed, min_distance, schools,
+//                 heading_jitter, center, inner_radius, outer_radius,
+//                 clockwise                                  (repeatable)
+//   [predator]    path = fixed | circle | line | hunt, position, center,
+//                 radius, period, from, to, speed            (repeatable)
+//   [obstacle]    position, radius                           (repeatable)
+//   [attractor]   position, radius, strength, capacity       (repeatable)
+//   [params]      max_speed, max_force, flow_strength, alarm_deposit,
+//                 alarm_weight, consume_rate, compact_threshold,
+//                 obstacle_weight, obstacle_margin, alarm_field
+//   [record]      path, format = csv | binary, every, stats
+//
+// Points are written "x y". '#' and ';' start comments. Unknown sections
+// and keys are errors, so a typo fails the run instead of being ignored;
+// so are out-of-range values (sizes, radii, speeds, periods and
+// capacities must be positive, threads at most the core count).
+
+// Scripted predator motion. Periods are in steps.
+struct PredatorScript {
+    enum Path { FIXED, CIRCLE, LINE, HUNT };
+    Path path = FIXED;
+    Vector2D position = Vector2D(-1000.0f, -1000.0f); // fixed spot, or hunt start
+    Vector2D center = Vector2D(0.0f, 0.0f);
+    float radius = 200.0f;
+    float period = 600.0f;
+    Vector2D from = Vector2D(0.0f, 0.0f), to = Vector2D(0.0f, 0.0f); // line, back and forth
+    float speed = 3.0f; // hunt: distance per step
+
+    // Position for the coming step. Hunting predators head for the
+    // nearest live boid from where they are.
+    Vector2D advance(uint64_t step, const Simulation& sim) {
+        const float phase = period > 0.0f ? std::fmod(static_cast<float>(step), period) / period : 0.0f;
+        switch (path) {
+        case FIXED:
+            break;
+        case CIRCLE: {
+            const float a = phase * 6.28318530718f;
+            position = Vector2D(center.x + radius * std::cos(a), center.y + radius * std::sin(a));
+            break;
+        }
+        case LINE: {
+            const float t = phase < 0.5f ? phase * 2.0f : 2.0f - phase * 2.0f;
+            position = from + (to - from) * t;
+            break;
+        }
+        case HUNT: {
+            float best = -1.0f;
+            Vector2D target = position;
+            for (size_t i = 0; i < sim.boids.size(); ++i) {
+                if (sim.tombstones.isDead(static_cast<int>(i))) continue;
+                Vector2D d = sim.boids[i].wrappedDiff(sim.boids[i].pos, position);
+                if (best < 0.0f || d.magSq() < best) {
+                    best = d.magSq();
+                    target = position + d;
+                }
+            }
+            Vector2D move = target - position;
+            move.limit(speed);
+            position += move;
+            position.x = spawnWrap(position.x, sim.width);
+            position.y = spawnWrap(position.y, sim.height);
+            break;
+        }
+        }
+        return position;
+    }
+};
+
+struct ScenarioParam {
+    std::string name;
+    float value;
+};
+
+struct Scenario {
+    float width = 1200.0f, height = 800.0f;
+    uint64_t seed = 1;
+    int threads = 0; // 0 = adaptive
+    long long steps = 1000;
+
+    struct Population {
+        SpawnSpec spec;
+        int count = 0;
+    };
+    std::vector<Population> populations;
+    std::vector<PredatorScript> predators;
+    std::vector<float> obstacles;  // rows of (x, y, radius)
+    std::vector<float> attractors; // rows of (x, y, radius, strength, capacity)
+    std::vector<ScenarioParam> params;
+    int alarmCols = 0, alarmRows = 0;
+
+    std::string recordPath;          // empty = no trajectory output
+    std::string recordFormat = "csv";
+    int recordEvery = 10;
+    std::string statsPath;           // per-record flock statistics (CSV)
+};
+
+inline std::string scenarioTrim(const std::string& s) {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    if (a == std::string::npos) return "";
+    size_t b = s.find_last_not_of(" \t\r\n");
+    return s.substr(a, b - a + 1);
+}
+
+// Reads a scenario; throws std::runtime_error("name:line: ...") on bad input.
+inline Scenario parseScenario(std::istream& in, const std::string& name) {
+    Scenario sc;
+    std::string section;
+    std::string line;
+    int lineNo = 0;
+
+    auto fail = [&](const std::string& msg) -> void {
+        throw std::runtime_error(name + ":" + std::to_string(lineNo) + ": " + msg);
+    };
+    auto numbers = [&](const std::string& v, int want) {
+        std::vector<float> out;
+        std::istringstream ss(v);
+        std::string tok;
+        while (ss >> tok) {
+            char* end = nullptr;
+            float f = std::strtof(tok.c_str(), &end);
+            if (end == tok.c_str() || *end != '\0' || !std::isfinite(f)) fail("not a number: " + tok);
+            out.push_back(f);
+        }
+        if (static_cast<int>(out.size()) != want) fail("expected " + std::to_string(want) + " number(s), got '" + v + "'");
+        return out;
+    };
+    auto number = [&](const std::string& v) { return numbers(v, 1)[0]; };
+    auto integer = [&](const std::string& v) {
+        char* end = nullptr;
+        long long n = std::strtoll(v.c_str(), &end, 10);
+        if (v.empty() || *end != '\0') fail("not an integer: " + v);
+        return n;
+    };
+    auto positive = [&](const std::string& v) {
+        float f = number(v);
+        if (!(f > 0.0f)) fail("expected a positive number, got '" + v + "'");
+        return f;
+    };
+    // Integer in [lo, INT_MAX]
+    auto bounded = [&](const std::string& v, long long lo) {
+        long long n = integer(v);
+        if (n < lo || n > std::numeric_limits<int>::max())
+            fail("expected an integer from " + std::to_string(lo) + " to " +
+                 std::to_string(std::numeric_limits<int>::max()) + ", got '" + v + "'");
+        return n;
+    };
+    auto point = [&](const std::string& v) {
+        std::vector<float> p = numbers(v, 2);
+        return Vector2D(p[0], p[1]);
+    };
+    auto flag = [&](const std::string& v) {
+        if (v == "true" || v == "yes" || v == "1") return true;
+        if (v == "false" || v == "no" || v == "0") return false;
+        fail("expected true or false, got '" + v + "'");
+        return false;
+    };
+
+    while (std::getline(in, line)) {
+        ++lineNo;
+        size_t hash = line.find_first_of("#;");
+        if (hash != std::string::npos) line.erase(hash);
+        line = scenarioTrim(line);
+        if (line.empty()) continue;
+
+        if (line[0] == '[') {
+            if (line.back() != ']') fail("unterminated section header");
+            section = scenarioTrim(line.substr(1, line.size() - 2));
+            if (section == "population") sc.populations.push_back(Scenario::Population());
+            else if (section == "predator") sc.predators.push_back(PredatorScript());
+            else if (section == "obstacle") sc.obstacles.insert(sc.obstacles.end(), { 0.0f, 0.0f, 50.0f });
+            else if (section == "attractor") sc.attractors.insert(sc.attractors.end(), { 0.0f, 0.0f, 50.0f, 1.0f, 100.0f });
+            else if (section != "world" && section != "run" && section != "params" && section != "record")
+                fail("unknown section [" + section + "]");
+            continue;
+        }
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) fail("expected key = value");
+        const std::string key = scenarioTrim(line.substr(0, eq));
+        const std::string v = scenarioTrim(line.substr(eq + 1));
+        bool known = true;
+
+        if (section == "world") {
+            if (key == "width") sc.width = positive(v);
+            else if (key == "height") sc.height = positive(v);
+            else if (key == "seed") sc.seed = static_cast<uint64_t>(integer(v));
+            else if (key == "threads") {
+                // More than the cores would only oversubscribe them
+                const long long t = integer(v);
+                if (t < 0 || t > omp_get_num_procs())
+                    fail("threads must be 0 (automatic) to " + std::to_string(omp_get_num_procs()));
+                sc.threads = static_cast<int>(t);
+            }
+            else known = false;
+        } else if (section == "run") {
+            if (key == "steps") {
+                sc.steps = integer(v);
+                if (sc.steps < 0) fail("steps must be >= 0");
+            }
+            else known = false;
+        } else if (section == "population") {
+            Scenario::Population& p = sc.populations.back();
+            SpawnSpec& s = p.spec;
+            if (key == "count") p.count = static_cast<int>(bounded(v, 0));
+            else if (key == "layout") {
+                if (v == "uniform") s.layout = SPAWN_UNIFORM;
+                else if (v == "poisson") s.layout = SPAWN_POISSON;
+                else if (v == "schools") s.layout = SPAWN_SCHOOLS;
+                else if (v == "mill") s.layout = SPAWN_MILL;
+                else fail("unknown layout '" + v + "'");
+            }
+            else if (key == "seed") s.seed = static_cast<uint64_t>(integer(v));
+            else if (key == "speed") s.speed = positive(v);
+            else if (key == "min_distance") {
+                s.minDistance = number(v);
+                if (s.minDistance < 0.0f) fail("min_distance must be >= 0 (0 picks the default spacing)");
+            }
+            else if (key == "schools") s.schools = static_cast<int>(bounded(v, 1));
+            else if (key == "heading_jitter") s.headingJitter = number(v);
+            else if (key == "center") s.center = point(v);
+            else if (key == "inner_radius") s.innerRadius = positive(v);
+            else if (key == "outer_radius") s.outerRadius = positive(v);
+            else if (key == "clockwise") s.clockwise = flag(v);
+            else known = false;
+        } else if (section == "predator") {
+            PredatorScript& p = sc.predators.back();
+            if (key == "path") {
+                if (v == "fixed") p.path = PredatorScript::FIXED;
+                else if (v == "circle") p.path = PredatorScript::CIRCLE;
+                else if (v == "line") p.path = PredatorScript::LINE;
+                else if (v == "hunt") p.path = PredatorScript::HUNT;
+                else fail("unknown predator path '" + v + "'");
+            }
+            else if (key == "position") p.position = point(v);
+            else if (key == "center") p.center = point(v);
+            else if (key == "radius") p.radius = positive(v);
+            else if (key == "period") p.period = positive(v);
+            else if (key == "from") p.from = point(v);
+            else if (key == "to") p.to = point(v);
+            else if (key == "speed") p.speed = positive(v);
+            else known = false;
+        } else if (section == "obstacle") {
+            float* o = &sc.obstacles[sc.obstacles.size() - 3];
+            if (key == "position") {
+                Vector2D c = point(v);
+                o[0] = c.x;
+                o[1] = c.y;
+            }
+            else if (key == "radius") o[2] = positive(v);
+            else known = false;
+        } else if (section == "attractor") {
+            float* a = &sc.attractors[sc.attractors.size() - 5];
+            if (key == "position") {
+                Vector2D c = point(v);
+                a[0] = c.x;
+                a[1] = c.y;
+            }
+            else if (key == "radius") a[2] = positive(v);
+            else if (key == "strength") a[3] = number(v);
+            else if (key == "capacity") a[4] = positive(v);
+            else known = false;
+        } else if (section == "params") {
+            if (key == "alarm_field") {
+                std::istringstream ss(v);
+                std::string cols, rows, extra;
+                if (!(ss >> cols >> rows) || (ss >> extra)) fail("alarm_field is 'cols rows'");
+                sc.alarmCols = static_cast<int>(bounded(cols, 1));
+                sc.alarmRows = static_cast<int>(bounded(rows, 1));
+            }
+            else if (key == "max_speed" || key == "max_force" || key == "flow_strength" || key == "alarm_deposit" ||
+                     key == "alarm_weight" || key == "consume_rate" || key == "compact_threshold" ||
+                     key == "obstacle_weight" || key == "obstacle_margin") {
+                ScenarioParam p;
+                p.name = key;
+                p.value = number(v);
+                sc.params.push_back(p);
+            }
+            else known = false;
+        } else if (section == "record") {
+            if (key == "path") sc.recordPath = v;
+            else if (key == "format") {
+                if (v != "csv" && v != "binary") fail("format must be csv or binary");
+                sc.recordFormat = v;
+            }
+            else if (key == "every") sc.recordEvery = static_cast<int>(bounded(v, 1));
+            else if (key == "stats") sc.statsPath = v;
+            else known = false;
+        } else {
+            fail("key outside a section");
+        }
+        if (!known) fail("unknown key '" + key + "' in [" + section + "]");
+    }
+    return sc;
+}
+
+// A simulation set up as the scenario describes, before its first step.
+// Population seeds are mixed with the world seed, so changing the world
+// seed reseeds every population.
+inline std::unique_ptr<Simulation> buildSimulation(const Scenario& sc) {
+    std::unique_ptr<Simulation> sim(new Simulation(0, sc.width, sc.height));
+    sim->tuner.setOverride(sc.threads);
+    for (const ScenarioParam& p : sc.params) {
+        if (p.name == "max_speed") sim->set_param(PARAM_MAX_SPEED, p.value);
+        else if (p.name == "max_force") sim->set_param(PARAM_MAX_FORCE, p.value);
+        else if (p.name == "flow_strength") sim->set_param(PARAM_FLOW_STRENGTH, p.value);
+        else if (p.name == "alarm_deposit") sim->set_param(PARAM_ALARM_DEPOSIT, p.value);
+        else if (p.name == "alarm_weight") sim->set_param(PARAM_ALARM_WEIGHT, p.value);
+        else if (p.name == "consume_rate") sim->set_param(PARAM_CONSUME_RATE, p.value);
+        else if (p.name == "compact_threshold") sim->compactThreshold = p.value;
+        else if (p.name == "obstacle_weight") sim->obstacleWeight = p.value;
+        else if (p.name == "obstacle_margin") sim->obstacles.margin = p.value;
+    }
+    for (size_t i = 0; i < sc.populations.size(); ++i) {
+        SpawnSpec spec = sc.populations[i].spec;
+        spec.seed = spawnHash(sc.seed, i, spec.seed);
+        sim->spawn(spec, sc.populations[i].count);
+    }
+    if (!sc.obstacles.empty()) sim->set_obstacles(sc.obstacles.data(), static_cast<int>(sc.obstacles.size() / 3));
+    if (!sc.attractors.empty()) sim->set_attractors(sc.attractors.data(), static_cast<int>(sc.attractors.size() / 5));
+    if (sc.alarmCols > 0 && sc.alarmRows > 0) sim->set_alarm_field(sc.alarmCols, sc.alarmRows);
+    return sim;
+}
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef SHAREDSTATE_H
+#define SHAREDSTATE_H
+
+#include "Boid.h"
+#include "Tombstones.h"
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Publishes completed frames into a POSIX shared-memory segment so other
+// processes (renderers, analytics) can map the latest state without any
+// per-consumer work in the simulation.
+//
+// The segment holds a few frame slots, each guarded by its own seqlock.
+// The writer fills the slot after the newest one (sequence odd while
+// writing, even when done) and then publishes its index. A reader takes
+// the newest slot and can keep using it zero-copy until the writer comes
+// round to it again; isValid() tells it whether that has happened.
+//
+// Frame data is (count, 4) floats of x, y, vx, vy, the same layout as
+// get_full_state() but contiguous.
+
+static const uint32_t SHARED_STATE_MAGIC = 0x42444653; // "SFDB"
+static const uint32_t SHARED_STATE_VERSION = 1;
+
+struct SharedStateHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    uint32_t capacity;
+    float width, height;
+    std::atomic<uint32_t> latest; // newest complete slot
+    uint32_t pad;
+    std::atomic<uint64_t> frames; // frames published so far
+};
+
+struct SharedSlotHeader {
+    std::atomic<uint64_t> seq;
+    uint64_t step;
+    uint32_t count;
+    uint32_t pad[11]; // keep each slot's data 64-byte aligned
+};
+
+inline size_t sharedSlotBytes(uint32_t capacity) {
+    return sizeof(SharedSlotHeader) + (size_t)capacity * 4 * sizeof(float);
+}
+
+inline size_t sharedSegmentBytes(uint32_t slots, uint32_t capacity) {
+    return 64 + (size_t)slots * sharedSlotBytes(capacity);
+}
+
+class SharedStatePublisher {
+    std::string name;
+    uint8_t* base = nullptr;
+    size_t bytes = 0;
+    SharedStateHeader* header = nullptr;
+
+    SharedSlotHeader* slot(uint32_t i) const {
+        return reinterpret_cast<SharedSlotHeader*>(base + 64 + i * sharedSlotBytes(header->capacity));
+    }
+
+public:
+    ~SharedStatePublisher() { close(); }
+
+    bool active() const { return base != nullptr; }
+    uint32_t capacity() const { return header ? header->capacity : 0; }
+
+    // Create (or replace) the named segment. Returns false on failure or on
+    // platforms without POSIX shared memory. An existing segment of that
+    // name is unlinked rather than rewritten in place: readers still mapping
+    // it keep a consistent (if stale) header, and the new one starts zeroed,
+    // so its magic only appears once the header is complete.
+    bool open(const std::string& segmentName, uint32_t cap, float width, float height, uint32_t slots = 3) {
+        close();
+#ifndef _WIN32
+        shm_unlink(segmentName.c_str());
+        int fd = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) return false;
+        size_t size = sharedSegmentBytes(slots, cap);
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            shm_unlink(segmentName.c_str());
+            return false;
+        }
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            shm_unlink(segmentName.c_str());
+            return false;
+        }
+
+        name = segmentName;
+        base = static_cast<uint8_t*>(p);
+        bytes = size;
+        header = reinterpret_cast<SharedStateHeader*>(base);
+        header->version = SHARED_STATE_VERSION;
+        header->slots = slots;
+        header->capacity = cap;
+        header->width = width;
+        header->height = height;
+        header->latest.store(0, std::memory_order_relaxed);
+        header->frames.store(0, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < slots; ++i) {
+            slot(i)->seq.store(0, std::memory_order_relaxed);
+            slot(i)->count = 0;
+        }
+        // Magic last, so readers never see a half-initialised header
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = SHARED_STATE_MAGIC;
+        return true;
+#else
+        (void)segmentName; (void)cap; (void)width; (void)height; (void)slots;
+        return false;
+#endif
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (!base) return;
+        munmap(base, bytes);
+        shm_unlink(name.c_str());
+#endif
+        base = nullptr;
+        header = nullptr;
+        bytes = 0;
+    }
+
+    // Copy a frame into the next slot. Boids beyond capacity are dropped;
+    // removed (not yet compacted) boids are written as NaN rows.
+    void publish(uint64_t step, const std::vector<Boid>& boids, int threads = 0,
+                 const Tombstones* dead = nullptr) {
+        if (threads <= 0) threads = omp_get_max_threads();
+        uint32_t next = (header->latest.load(std::memory_order_relaxed) + 1) % header->slots;
+        if (header->frames.load(std::memory_order_relaxed) == 0) next = 0;
+        SharedSlotHeader* s = slot(next);
+        int count = static_cast<int>(std::min<size_t>(boids.size(), header->capacity));
+
+        uint64_t seq = s->seq.load(std::memory_order_relaxed);
+        s->seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        float* out = reinterpret_cast<float*>(s + 1);
+        #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+        for (int i = 0; i < count; ++i) {
+            if (dead && dead->isDead(i)) {
+                std::fill(out + i * 4, out + i * 4 + 4, std::numeric_limits<float>::quiet_NaN());
+                continue;
+            }
+            const Boid& b = boids[i];
+            out[i * 4 + 0] = b.pos.x;
+            out[i * 4 + 1] = b.pos.y;
+            out[i * 4 + 2] = b.vel.x;
+            out[i * 4 + 3] = b.vel.y;
+        }
+        s->step = step;
+        s->count = static_cast<uint32_t>(count);
+
+        s->seq.store(seq + 2, std::memory_order_release);
+        header->latest.store(next, std::memory_order_release);
+        header->frames.fetch_add(1, std::memory_order_release);
+    }
+};
+
+// Read side; usable from any process.
+class SharedStateReader {
+    uint8_t* base = nullptr;
+    size_t bytes = 0;
+    const SharedStateHeader* header = nullptr;
+
+    const SharedSlotHeader* slot(uint32_t i) const {
+        return reinterpret_cast<const SharedSlotHeader*>(base + 64 + i * sharedSlotBytes(header->capacity));
+    }
+
+public:
+    struct Frame {
+        const float* data; // count x 4 floats
+        uint32_t count;
+        uint64_t step;
+        uint32_t slot;
+        uint64_t seq;
+    };
+
+    // Zero-copy views of the mapping still alive (the Python binding
+    // counts its arrays here); close() won't unmap while any are.
+    int views = 0;
+
+    ~SharedStateReader() {
+        views = 0;
+        close();
+    }
+
+    bool open(const std::string& segmentName) {
+        if (!close()) return false;
+#ifndef _WIN32
+        int fd = shm_open(segmentName.c_str(), O_RDONLY, 0);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SharedStateHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+
+        base = static_cast<uint8_t*>(p);
+        bytes = st.st_size;
+        header = reinterpret_cast<const SharedStateHeader*>(base);
+        // Magic first, then the fence that pairs with the writer's release
+        const uint32_t magic = header->magic;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (magic != SHARED_STATE_MAGIC || header->version != SHARED_STATE_VERSION ||
+            bytes < sharedSegmentBytes(header->slots, header->capacity)) {
+            close();
+            return false;
+        }
+        return true;
+#else
+        (void)segmentName;
+        return false;
+#endif
+    }
+
+    // Unmaps the segment; returns false (and keeps it) while views are alive
+    bool close() {
+        if (views > 0) return false;
+#ifndef _WIN32
+        if (base) munmap(base, bytes);
+#endif
+        base = nullptr;
+        header = nullptr;
+        bytes = 0;
+        return true;
+    }
+
+    bool isOpen() const { return base != nullptr; }
+    float width() const { return header ? header->width : 0.0f; }
+    float height() const { return header ? header->height : 0.0f; }
+    uint64_t framesPublished() const { return header ? header->frames.load(std::memory_order_acquire) : 0; }
+
+    // Newest consistent frame. Returns false if nothing has been published
+    // yet or the writer kept lapping us.
+    bool latest(Frame& f) const {
+        if (!header) return false;
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            if (header->frames.load(std::memory_order_acquire) == 0) return false;
+            uint32_t i = header->latest.load(std::memory_order_acquire);
+            if (i >= header->slots) return false;
+            const SharedSlotHeader* s = slot(i);
+            uint64_t seq = s->seq.load(std::memory_order_acquire);
+            if (seq & 1) continue;
+            f.data = reinterpret_cast<const float*>(s + 1);
+            f.count = std::min(s->count, header->capacity);
+            f.step = s->step;
+            f.slot = i;
+            f.seq = seq;
+            if (isValid(f)) return true;
+        }
+        return false;
+    }
+
+    // True while the frame's slot has not been rewritten. A slot outside
+    // the segment (a stale or forged token) is never valid.
+    bool isValid(const Frame& f) const {
+        if (!header || f.slot >= header->slots) return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot(f.slot)->seq.load(std::memory_order_relaxed) == f.seq;
+    }
+};
+
+#endif
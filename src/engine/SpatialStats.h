@@ -0,0 +1,145 @@
+#ifndef SPATIALSTATS_H
+#define SPATIALSTATS_H
+
+#include "Boid.h"
+#include "Grid.h"
+#include "Tombstones.h"
+#include <omp.h>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <cmath>
+
+// Spatial statistics computed from the engine's grid. Everything is
+// periodic, matching the wrapped world, so results are exact as long as
+// the radii stay below half the world size. The grid holds only live
+// boids; dead rows are skipped and get NaN in per-boid outputs. Each
+// runs on `threads` threads (<= 0: all of them).
+
+// Bin index for a distance, given monotonically increasing bin edges
+// (nbins + 1 of them). Uniform edges take a division, others a search.
+struct RadialBins {
+    const float* edges;
+    int nbins;
+    bool uniform;
+    float invWidth;
+
+    RadialBins(const float* e, int n) : edges(e), nbins(n), uniform(true), invWidth(0.0f) {
+        float w = (e[n] - e[0]) / n;
+        for (int k = 0; k < n && uniform; ++k) {
+            uniform = std::fabs((e[k + 1] - e[k]) - w) <= 1e-5f * std::max(1.0f, w);
+        }
+        invWidth = 1.0f / w;
+    }
+
+    float maxRadius() const { return edges[nbins]; }
+
+    int operator()(float d) const {
+        if (d < edges[0] || d >= edges[nbins]) return -1;
+        if (uniform) return std::min(nbins - 1, static_cast<int>((d - edges[0]) * invWidth));
+        return static_cast<int>(std::upper_bound(edges, edges + nbins + 1, d) - edges) - 1;
+    }
+};
+
+// Radial distribution function g(r). Pair distances are histogrammed into
+// per-thread bins that are merged afterwards, then normalised by the
+// ideal-gas expectation N * rho * shell area.
+inline void pairCorrelation(const std::vector<Boid>& boids, const Tombstones& dead, const Grid& grid,
+                            float width, float height,
+                            const float* edges, int nbins, double* g, int threads = 0) {
+    int n = static_cast<int>(boids.size());
+    const int alive = dead.aliveCount();
+    RadialBins bins(edges, nbins);
+    const float rMax = bins.maxRadius();
+    const float rMaxSq = rMax * rMax;
+    if (threads <= 0) threads = omp_get_max_threads();
+    std::vector<int64_t> local((size_t)threads * nbins, 0);
+
+    #pragma omp parallel num_threads(threads) if(threads > 1)
+    {
+        int64_t* hist = &local[(size_t)omp_get_thread_num() * nbins];
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < n; ++i) {
+            if (dead.isDead(i)) continue;
+            const Boid& b = boids[i];
+            grid.forEachNear(b.pos.x, b.pos.y, rMax, [&](const Boid* o) {
+                if (o == &b) return;
+                float dSq = b.wrappedDiff(b.pos, o->pos).magSq();
+                if (dSq >= rMaxSq) return;
+                int k = bins(std::sqrt(dSq));
+                if (k >= 0) hist[k]++;
+            });
+        }
+    }
+
+    const double pi = 3.14159265358979323846;
+    const double rho = alive / (double(width) * height);
+    for (int k = 0; k < nbins; ++k) {
+        int64_t total = 0;
+        for (int t = 0; t < threads; ++t) total += local[(size_t)t * nbins + k];
+        double r0 = edges[k], r1 = edges[k + 1];
+        double expected = alive * rho * pi * (r1 * r1 - r0 * r0);
+        g[k] = expected > 0.0 ? total / expected : 0.0;
+    }
+}
+
+// Number of other boids within radius of each boid, divided by the disc
+// area (boids per square unit).
+inline void localDensity(const std::vector<Boid>& boids, const Tombstones& dead, const Grid& grid,
+                         float radius, float* out, int threads = 0) {
+    int n = static_cast<int>(boids.size());
+    const float rSq = radius * radius;
+    const float invArea = 1.0f / (3.14159265358979f * rSq);
+    if (threads <= 0) threads = omp_get_max_threads();
+
+    #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+    for (int i = 0; i < n; ++i) {
+        if (dead.isDead(i)) {
+            out[i] = std::numeric_limits<float>::quiet_NaN();
+            continue;
+        }
+        const Boid& b = boids[i];
+        int count = 0;
+        grid.forEachNear(b.pos.x, b.pos.y, radius, [&](const Boid* o) {
+            if (o != &b && b.wrappedDiff(b.pos, o->pos).magSq() < rSq) ++count;
+        });
+        out[i] = count * invArea;
+    }
+}
+
+// Distance to the nearest other boid, searching out to maxRadius; boids
+// with nobody that close get +inf.
+inline void nearestNeighborDistances(const std::vector<Boid>& boids, const Tombstones& dead, const Grid& grid,
+                                     float maxRadius, float* out, int threads = 0) {
+    int n = static_cast<int>(boids.size());
+    const float rSq = maxRadius * maxRadius;
+    if (threads <= 0) threads = omp_get_max_threads();
+
+    #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+    for (int i = 0; i < n; ++i) {
+        if (dead.isDead(i)) {
+            out[i] = std::numeric_limits<float>::quiet_NaN();
+            continue;
+        }
+        const Boid& b = boids[i];
+        float best = rSq;
+        auto visit = [&](const Boid* o) {
+            if (o == &b) return;
+            float dSq = b.wrappedDiff(b.pos, o->pos).magSq();
+            if (dSq < best) best = dSq;
+        };
+
+        // Anything outside the 3x3 block is at least one cell away, so a
+        // hit within a cell size there is final and the wide search is skipped.
+        float nearRadius = std::min(maxRadius, grid.getCellSize());
+        grid.forEachNear(b.pos.x, b.pos.y, nearRadius, visit);
+        if (best > nearRadius * nearRadius && maxRadius > nearRadius) {
+            grid.forEachNear(b.pos.x, b.pos.y, maxRadius, visit);
+        }
+        out[i] = best < rSq ? std::sqrt(best) : std::numeric_limits<float>::infinity();
+    }
+}
+
+#endif
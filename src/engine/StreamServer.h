@@ -0,0 +1,397 @@
+#ifndef STREAMSERVER_H
+#define STREAMSERVER_H
+
+#include "Boid.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <omp.h>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// Streams live frames to dashboards over a Unix domain socket
+// ("unix:/path") or localhost TCP ("tcp:port").
+//
+// step() only quantises positions into a staging buffer (and skips even
+// that when nobody is connected); a dedicated I/O thread encodes and sends.
+// A client whose previous frame has not fully drained yet simply misses
+// frames, so a slow consumer never blocks the simulation.
+//
+// Protocol, little-endian:
+//   client -> server, 24 bytes at any time:
+//     char 'S', 3 pad bytes, uint32 every (send every Nth frame),
+//     float x0, y0, x1, y1 (viewport; all zero for the whole world)
+//   server -> client, 32-byte header then payload:
+//     uint32 magic 'BFRM', uint32 payload bytes, uint64 step,
+//     uint32 count, uint8 kind, 3 pad bytes, float width, float height
+//   kind 0 (key):      count x (uint16 x, uint16 y)
+//   kind 1 (delta):    count x (zigzag varint dx, dy), per-boid differences
+//                      from the previous frame sent to this client, mod 2^16
+//   kind 2 (viewport): count x (uint32 index, uint16 x, uint16 y)
+// Coordinates are quantised as q = pos / world_size * 65535.
+class StreamServer {
+public:
+    static const uint32_t FRAME_MAGIC = 0x4D524642; // "BFRM"
+    static const int KEYFRAME_INTERVAL = 120;
+
+private:
+    struct Client {
+        int fd;
+        uint32_t every = 1;
+        float vx0 = 0, vy0 = 0, vx1 = 0, vy1 = 0;
+        std::vector<uint8_t> inbox;
+        std::vector<uint8_t> outbox;
+        size_t sent = 0;
+        std::vector<uint16_t> last; // last full frame sent, for deltas
+        uint64_t framesSeen = 0;
+        int sinceKey = 0;
+        bool subscribed = false;
+    };
+
+    int listenFd = -1;
+    int wakeFds[2] = { -1, -1 };
+    std::string unixPath;
+    float width = 0, height = 0;
+
+    std::thread io;
+    std::atomic<bool> running;
+    std::atomic<int> subscribers;
+
+    // Hand-off between step() and the I/O thread
+    std::mutex frameMutex;
+    std::vector<uint16_t> staging, current;
+    uint64_t stagingStep = 0, currentStep = 0;
+    bool fresh = false;
+
+    std::vector<Client> clients;
+
+    static void putVarint(std::vector<uint8_t>& out, uint32_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    static uint32_t zigzag(int32_t v) { return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31); }
+
+    template <typename T>
+    static void put(std::vector<uint8_t>& out, T v) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+
+    void encodeFor(Client& c) {
+        int n = static_cast<int>(current.size() / 2);
+        std::vector<uint8_t>& out = c.outbox;
+        out.clear();
+        c.sent = 0;
+        out.resize(32);
+
+        uint8_t kind;
+        uint32_t count = 0;
+        bool viewport = c.vx1 > c.vx0 && c.vy1 > c.vy0;
+
+        if (viewport) {
+            kind = 2;
+            float qx0 = c.vx0 / width * 65535.0f, qx1 = c.vx1 / width * 65535.0f;
+            float qy0 = c.vy0 / height * 65535.0f, qy1 = c.vy1 / height * 65535.0f;
+            for (int i = 0; i < n; ++i) {
+                float x = current[2 * i], y = current[2 * i + 1];
+                if (x < qx0 || x > qx1 || y < qy0 || y > qy1) continue;
+                put<uint32_t>(out, static_cast<uint32_t>(i));
+                put<uint16_t>(out, current[2 * i]);
+                put<uint16_t>(out, current[2 * i + 1]);
+                ++count;
+            }
+            c.last.clear();
+        } else if (c.last.size() == current.size() && c.sinceKey < KEYFRAME_INTERVAL) {
+            kind = 1;
+            count = n;
+            for (size_t k = 0; k < current.size(); ++k) {
+                int16_t d = static_cast<int16_t>(static_cast<uint16_t>(current[k] - c.last[k]));
+                putVarint(out, zigzag(d));
+            }
+            c.last = current;
+            ++c.sinceKey;
+        } else {
+            kind = 0;
+            count = n;
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(current.data());
+            out.insert(out.end(), p, p + current.size() * sizeof(uint16_t));
+            c.last = current;
+            c.sinceKey = 0;
+        }
+
+        uint32_t payload = static_cast<uint32_t>(out.size() - 32);
+        uint8_t* h = out.data();
+        uint32_t magic = FRAME_MAGIC;
+        std::memcpy(h + 0, &magic, 4);
+        std::memcpy(h + 4, &payload, 4);
+        std::memcpy(h + 8, &currentStep, 8);
+        std::memcpy(h + 16, &count, 4);
+        h[20] = kind;
+        h[21] = h[22] = h[23] = 0;
+        std::memcpy(h + 24, &width, 4);
+        std::memcpy(h + 28, &height, 4);
+    }
+
+#ifndef _WIN32
+    static void setNonBlocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK); }
+
+    static ssize_t sendSome(int fd, const uint8_t* p, size_t len) {
+#ifdef MSG_NOSIGNAL
+        return ::send(fd, p, len, MSG_NOSIGNAL);
+#else
+        return ::send(fd, p, len, 0);
+#endif
+    }
+
+    void drop(size_t i) {
+        ::close(clients[i].fd);
+        if (clients[i].subscribed) subscribers.fetch_sub(1);
+        clients.erase(clients.begin() + i);
+    }
+
+    // Parse subscribe messages; returns false if the client hung up.
+    bool readFrom(Client& c) {
+        uint8_t buf[256];
+        while (true) {
+            ssize_t r = ::recv(c.fd, buf, sizeof(buf), 0);
+            if (r == 0) return false;
+            if (r < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            c.inbox.insert(c.inbox.end(), buf, buf + r);
+            while (c.inbox.size() >= 24) {
+                if (c.inbox[0] != 'S') return false;
+                uint32_t every;
+                std::memcpy(&every, &c.inbox[4], 4);
+                std::memcpy(&c.vx0, &c.inbox[8], 4);
+                std::memcpy(&c.vy0, &c.inbox[12], 4);
+                std::memcpy(&c.vx1, &c.inbox[16], 4);
+                std::memcpy(&c.vy1, &c.inbox[20], 4);
+                c.every = every > 0 ? every : 1;
+                c.inbox.erase(c.inbox.begin(), c.inbox.begin() + 24);
+                if (!c.subscribed) {
+                    c.subscribed = true;
+                    subscribers.fetch_add(1);
+                }
+            }
+        }
+    }
+
+    // Push as much of the outbox as the socket takes; false on error.
+    bool flush(Client& c) {
+        while (c.sent < c.outbox.size()) {
+            ssize_t w = sendSome(c.fd, c.outbox.data() + c.sent, c.outbox.size() - c.sent);
+            if (w < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            c.sent += static_cast<size_t>(w);
+        }
+        return true;
+    }
+
+    void run() {
+        std::vector<pollfd> fds;
+        while (running.load()) {
+            fds.clear();
+            pollfd p;
+            p.fd = listenFd; p.events = POLLIN; p.revents = 0;
+            fds.push_back(p);
+            p.fd = wakeFds[0];
+            fds.push_back(p);
+            for (const Client& c : clients) {
+                p.fd = c.fd;
+                p.events = POLLIN | (c.sent < c.outbox.size() ? POLLOUT : 0);
+                fds.push_back(p);
+            }
+
+            if (::poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR) break;
+
+            if (fds[1].revents & POLLIN) {
+                uint8_t sink[64];
+                while (::read(wakeFds[0], sink, sizeof(sink)) > 0) {}
+            }
+
+            for (size_t i = clients.size(); i-- > 0;) {
+                short ev = fds[i + 2].revents;
+                bool ok = true;
+                if (ev & (POLLERR | POLLHUP | POLLNVAL)) ok = false;
+                if (ok && (ev & POLLIN)) ok = readFrom(clients[i]);
+                if (ok && (ev & POLLOUT)) ok = flush(clients[i]);
+                if (!ok) drop(i);
+            }
+
+            if (fds[0].revents & POLLIN) {
+                int fd;
+                while ((fd = ::accept(listenFd, nullptr, nullptr)) >= 0) {
+                    setNonBlocking(fd);
+                    Client c;
+                    c.fd = fd;
+                    clients.push_back(c);
+                }
+            }
+
+            bool have = false;
+            {
+                std::lock_guard<std::mutex> lock(frameMutex);
+                if (fresh) {
+                    current.swap(staging);
+                    currentStep = stagingStep;
+                    fresh = false;
+                    have = true;
+                }
+            }
+            if (!have) continue;
+
+            for (size_t i = clients.size(); i-- > 0;) {
+                Client& c = clients[i];
+                if (!c.subscribed) continue;
+                if (c.framesSeen++ % c.every != 0) continue;
+                // Backpressure: previous frame still draining, skip this one
+                if (c.sent < c.outbox.size()) continue;
+                encodeFor(c);
+                if (!flush(c)) drop(i);
+            }
+        }
+    }
+#endif
+
+public:
+    StreamServer() : running(false), subscribers(0) {}
+    ~StreamServer() { stop(); }
+
+    bool active() const { return running.load(); }
+    int subscriberCount() const { return subscribers.load(); }
+
+    // Fails on a malformed address, a port outside 1..65535, or a unix
+    // path that exists and is not a socket (a stale socket is replaced).
+    bool start(const std::string& address, float worldW, float worldH) {
+        stop();
+#ifndef _WIN32
+        width = worldW;
+        height = worldH;
+        if (address.compare(0, 5, "unix:") == 0) {
+            const std::string path = address.substr(5);
+            sockaddr_un sa;
+            std::memset(&sa, 0, sizeof(sa));
+            sa.sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof(sa.sun_path)) return false;
+            std::strcpy(sa.sun_path, path.c_str());
+            struct stat st;
+            if (::lstat(path.c_str(), &st) == 0) {
+                if (!S_ISSOCK(st.st_mode)) return false;
+                ::unlink(path.c_str());
+            }
+            listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (listenFd < 0 || ::bind(listenFd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0) {
+                stop();
+                return false;
+            }
+            unixPath = path; // ours now, removed again by stop()
+        } else if (address.compare(0, 4, "tcp:") == 0) {
+            const char* digits = address.c_str() + 4;
+            char* end = nullptr;
+            errno = 0;
+            long port = std::strtol(digits, &end, 10);
+            if (end == digits || *end != '\0' || errno != 0 || port < 1 || port > 65535) return false;
+            sockaddr_in sa;
+            std::memset(&sa, 0, sizeof(sa));
+            sa.sin_family = AF_INET;
+            sa.sin_port = htons(static_cast<uint16_t>(port));
+            sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+            int one = 1;
+            if (listenFd >= 0) ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (listenFd < 0 || ::bind(listenFd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0) {
+                stop();
+                return false;
+            }
+        } else {
+            return false;
+        }
+
+        if (::listen(listenFd, 16) != 0 || ::pipe(wakeFds) != 0) {
+            stop();
+            return false;
+        }
+        setNonBlocking(listenFd);
+        setNonBlocking(wakeFds[0]);
+        setNonBlocking(wakeFds[1]);
+
+        running.store(true);
+        io = std::thread(&StreamServer::run, this);
+        return true;
+#else
+        (void)address; (void)worldW; (void)worldH;
+        return false;
+#endif
+    }
+
+    void stop() {
+#ifndef _WIN32
+        running.store(false);
+        if (io.joinable()) {
+            uint8_t b = 0;
+            if (::write(wakeFds[1], &b, 1) < 0) {}
+            io.join();
+        }
+        for (Client& c : clients) ::close(c.fd);
+        clients.clear();
+        subscribers.store(0);
+        if (listenFd >= 0) ::close(listenFd);
+        if (wakeFds[0] >= 0) ::close(wakeFds[0]);
+        if (wakeFds[1] >= 0) ::close(wakeFds[1]);
+        if (!unixPath.empty()) ::unlink(unixPath.c_str());
+#endif
+        listenFd = wakeFds[0] = wakeFds[1] = -1;
+        unixPath.clear();
+    }
+
+    // Called at the end of a step, quantising on `threads` threads (<= 0:
+    // all). Never waits: if the I/O thread is busy swapping buffers the
+    // frame is dropped.
+    void offer(uint64_t step, const std::vector<Boid>& boids, int threads = 0) {
+        if (subscribers.load(std::memory_order_relaxed) == 0) return;
+        std::unique_lock<std::mutex> lock(frameMutex, std::try_to_lock);
+        if (!lock.owns_lock()) return;
+
+        int n = static_cast<int>(boids.size());
+        staging.resize((size_t)n * 2);
+        const float qx = 65535.0f / width, qy = 65535.0f / height;
+        uint16_t* out = staging.data();
+        if (threads <= 0) threads = omp_get_max_threads();
+        #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+        for (int i = 0; i < n; ++i) {
+            float x = std::min(std::max(boids[i].pos.x * qx, 0.0f), 65535.0f);
+            float y = std::min(std::max(boids[i].pos.y * qy, 0.0f), 65535.0f);
+            out[2 * i] = static_cast<uint16_t>(x + 0.5f);
+            out[2 * i + 1] = static_cast<uint16_t>(y + 0.5f);
+        }
+        stagingStep = step;
+        fresh = true;
+        lock.unlock();
+
+#ifndef _WIN32
+        uint8_t b = 1;
+        if (::write(wakeFds[1], &b, 1) < 0) {} // pipe full means already woken
+#endif
+    }
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef THREADTUNER_H
+#define THREADTUNER_H
+
+#include <omp.h>
+#include <cmath>
+#include <algorithm>
+
+// Parallel phases of a step that pick their own thread count.
+enum StepPhase {
+    PHASE_FLOCK,   // neighbour search + integration
+    PHASE_DIFFUSE, // alarm field stencil
+    PHASE_PUBLISH, // shared-memory copy
+    PHASE_ATTRACT, // merge of per-thread attractor consumption
+    PHASE_STREAM,  // stream server quantisation
+    PHASE_INTERP,  // render interpolation
+    PHASE_RENDER,  // render geometry
+    PHASE_PAIRS,   // g(r) histogram
+    PHASE_DENSITY, // local density
+    PHASE_NEAREST, // nearest-neighbour distances
+    PHASE_EXPORT,  // Arrow column split
+    PHASE_COUNT
+};
+
+// Chooses how many OpenMP threads each phase should use. A parallel region
+// costs roughly `overhead * threads` to fork and join and the work splits
+// over min(threads, cores actually available), so the phase takes
+// work / min(t, speedup) + overhead * t and the best t is picked from that
+// (which can be 1: small phases run inline). The fork/join overhead is
+// calibrated once per process. Per phase, single-threaded runs measure
+// the per-item cost and parallel runs measure the speedup really achieved,
+// so an oversubscribed or shared machine settles on fewer threads. Every
+// probeInterval calls the other choice is tried again, in case the load
+// on the machine has changed.
+class ThreadTuner {
+    struct PhaseStats {
+        double secPerItem = 0.0; // single-thread cost per item
+        double speedup = 0.0;    // measured parallel speedup (0 = unknown)
+        int lastThreads = 1;
+        unsigned calls = 0;
+    };
+
+    PhaseStats stats[PHASE_COUNT];
+    int maxThreads;
+    int fixed = 0; // > 0 overrides the choice
+
+    static double predicted(double work, double o, double cores, int t) {
+        return t == 1 ? work : work / std::min<double>(t, cores) + o * t;
+    }
+
+    int best(double work, double o, double cores) const {
+        int t = 1;
+        double bestTime = work;
+        for (int k = 2; k <= maxThreads; ++k) {
+            double time = predicted(work, o, cores, k);
+            if (time < bestTime) {
+                bestTime = time;
+                t = k;
+            }
+        }
+        return t;
+    }
+
+public:
+    static const unsigned probeInterval = 1024;
+
+    ThreadTuner() : maxThreads(std::max(1, omp_get_max_threads())) {}
+
+    // Seconds of fork/join cost per participating thread, measured with
+    // empty regions across all threads.
+    static double overhead() {
+        static const double perThread = []() {
+            const int threads = std::max(1, omp_get_max_threads());
+            if (threads == 1) return 0.0;
+            const int reps = 200;
+            volatile int sink = 0;
+            #pragma omp parallel num_threads(threads)
+            { sink = 1; } // warm the pool up first
+            double t0 = omp_get_wtime();
+            for (int r = 0; r < reps; ++r) {
+                #pragma omp parallel num_threads(threads)
+                { if (omp_get_thread_num() == 0) sink = r; }
+            }
+            (void)sink;
+            return (omp_get_wtime() - t0) / reps / threads;
+        }();
+        return perThread;
+    }
+
+    // Clamped to the OpenMP maximum: per-thread scratch is sized by it
+    void setOverride(int threads) { fixed = std::min(std::max(0, threads), maxThreads); }
+    int getOverride() const { return fixed; }
+    int lastThreads(StepPhase p) const { return stats[p].lastThreads; }
+
+    // Thread count for a phase about to process `items` work items.
+    int threadsFor(StepPhase p, long long items) {
+        PhaseStats& s = stats[p];
+        int t = 1;
+        if (fixed > 0) {
+            t = std::min(fixed, std::max(1, omp_get_max_threads()));
+        } else if (s.secPerItem > 0.0 && maxThreads > 1) {
+            // (not measured yet: one inline run gives the per-item cost)
+            double work = s.secPerItem * static_cast<double>(items);
+            double o = overhead();
+            int ideal = best(work, o, maxThreads);
+            t = s.speedup > 0.0 ? best(work, o, s.speedup) : ideal;
+            if (++s.calls % probeInterval == 0) t = (t == 1) ? ideal : 1;
+        }
+        s.lastThreads = t;
+        return t;
+    }
+
+    // Feed back the wall time of a phase run with `threads` threads.
+    void record(StepPhase p, long long items, int threads, double seconds) {
+        if (items <= 0 || fixed > 0) return;
+        PhaseStats& s = stats[p];
+        if (threads == 1) {
+            double perItem = seconds / static_cast<double>(items);
+            s.secPerItem = (s.secPerItem == 0.0) ? perItem : 0.8 * s.secPerItem + 0.2 * perItem;
+        } else if (s.secPerItem > 0.0) {
+            double parallel = std::max(1e-9, seconds - overhead() * threads);
+            double observed = std::max(0.1, std::min<double>(threads, s.secPerItem * items / parallel));
+            s.speedup = (s.speedup == 0.0) ? observed : 0.8 * s.speedup + 0.2 * observed;
+        }
+    }
+};
+
+#endif
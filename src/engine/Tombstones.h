@@ -0,0 +1,71 @@
+#ifndef TOMBSTONES_H
+#define TOMBSTONES_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+// One bit per boid, set when the boid has been removed but not yet
+// compacted away. Removal is then O(1) per boid and every index (and any
+// NumPy view of the boid array) stays valid until the next compaction.
+class Tombstones {
+    std::vector<uint64_t> words;
+    int count = 0;
+    int dead = 0;
+
+public:
+    // n boids, all alive.
+    void reset(int n) {
+        count = n;
+        dead = 0;
+        words.assign((size_t)(n + 63) / 64, 0);
+    }
+
+    // Grow to n boids; the new ones are alive.
+    void grow(int n) {
+        if (n <= count) return;
+        count = n;
+        words.resize((size_t)(n + 63) / 64, 0);
+    }
+
+    int size() const { return count; }
+    int deadCount() const { return dead; }
+    int aliveCount() const { return count - dead; }
+
+    bool isDead(int i) const {
+        return dead != 0 && ((words[(size_t)i >> 6] >> (i & 63)) & 1u);
+    }
+
+    // Returns true if i was alive.
+    bool kill(int i) {
+        uint64_t bit = uint64_t(1) << (i & 63);
+        uint64_t& w = words[(size_t)i >> 6];
+        if (w & bit) return false;
+        w |= bit;
+        ++dead;
+        return true;
+    }
+
+    // The raw bitmap, one bit per boid in 64-bit words (for snapshots).
+    const uint64_t* bits() const { return words.data(); }
+    static size_t bytesFor(int n) { return (size_t)(n + 63) / 64 * sizeof(uint64_t); }
+
+    // Inverse of bits(): n boids, dead where the bit is set.
+    void load(const void* bits, int n) {
+        reset(n);
+        if (n <= 0) return;
+        std::memcpy(words.data(), bits, bytesFor(n));
+        if (n & 63) words.back() &= (uint64_t(1) << (n & 63)) - 1;
+        for (uint64_t w : words) {
+            for (; w; w &= w - 1) ++dead;
+        }
+    }
+
+    // keep[i] = 1 for the boids that survive compaction.
+    void keepMask(std::vector<char>& keep) const {
+        keep.resize(count);
+        for (int i = 0; i < count; ++i) keep[i] = isDead(i) ? 0 : 1;
+    }
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef TRAILS_H
+#define TRAILS_H
+
+#include "Vector2D.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// Ring buffer of the last `length` positions of every boid, stored as two
+// slot-major uint16 planes (x and y quantised to the world size). Slot s
+// holds boid i at [s * count + i], so each step writes one contiguous row
+// per plane and NumPy can view a plane as a (length, count) array.
+class TrailBuffer {
+    int length = 0;
+    int count = 0;
+    int head = 0;   // slot written by the current step
+    int filled = 0; // number of valid slots
+    float quantX = 0.0f, quantY = 0.0f; // quanta per world unit
+    std::vector<uint16_t> xs, ys;
+    uint64_t gen = 0; // bumped whenever the planes are reallocated
+
+public:
+    bool active() const { return length > 0; }
+    int numSlots() const { return length; }
+    int numBoids() const { return count; }
+    int filledSlots() const { return filled; }
+    // Slot holding the most recent positions
+    int latestSlot() const { return (head + length - 1) % length; }
+    float scaleX() const { return 1.0f / quantX; }
+    float scaleY() const { return 1.0f / quantY; }
+    uint16_t* xData() { return xs.data(); }
+    uint16_t* yData() { return ys.data(); }
+    // Changes whenever xData()/yData() may have moved or changed shape:
+    // on resize, clear, extend (added boids) and compact.
+    uint64_t generation() const { return gen; }
+
+    void resize(int len, int n, float worldW, float worldH) {
+        length = len;
+        count = n;
+        head = 0;
+        filled = 0;
+        quantX = 65535.0f / worldW;
+        quantY = 65535.0f / worldH;
+        xs.assign((size_t)len * n, 0);
+        ys.assign((size_t)len * n, 0);
+        ++gen;
+    }
+
+    void clear() {
+        length = count = head = filled = 0;
+        xs.clear();
+        ys.clear();
+        ++gen;
+    }
+
+    void record(int i, Vector2D pos) {
+        size_t k = (size_t)head * count + i;
+        xs[k] = static_cast<uint16_t>(std::min(std::max(pos.x * quantX, 0.0f), 65535.0f) + 0.5f);
+        ys[k] = static_cast<uint16_t>(std::min(std::max(pos.y * quantY, 0.0f), 65535.0f) + 0.5f);
+    }
+
+    // Called once after every boid has been recorded for this step.
+    void advance() {
+        head = (head + 1) % length;
+        if (filled < length) ++filled;
+    }
+
+    // Append columns for newly added boids, seeding their whole history with
+    // their starting position. Rows move towards the back, so go backwards.
+    void extend(const std::vector<Vector2D>& positions) {
+        int added = static_cast<int>(positions.size());
+        int total = count + added;
+        xs.resize((size_t)length * total);
+        ys.resize((size_t)length * total);
+        for (int s = length - 1; s >= 0; --s) {
+            std::copy_backward(xs.begin() + (size_t)s * count, xs.begin() + (size_t)(s + 1) * count,
+                               xs.begin() + (size_t)s * total + count);
+            std::copy_backward(ys.begin() + (size_t)s * count, ys.begin() + (size_t)(s + 1) * count,
+                               ys.begin() + (size_t)s * total + count);
+        }
+        int oldCount = count;
+        int oldHead = head;
+        count = total;
+        for (int s = 0; s < length; ++s) {
+            head = s;
+            for (int k = 0; k < added; ++k) record(oldCount + k, positions[k]);
+        }
+        head = oldHead;
+        ++gen;
+    }
+
+    // Drop the columns of removed boids; keep[i] is false for those.
+    // Rows only ever move towards the front, so this works in place.
+    void compact(const std::vector<char>& keep) {
+        int kept = static_cast<int>(std::count(keep.begin(), keep.end(), 1));
+        for (int s = 0; s < length; ++s) {
+            size_t src = (size_t)s * count;
+            size_t dst = (size_t)s * kept;
+            for (int i = 0; i < count; ++i) {
+                if (!keep[i]) continue;
+                xs[dst] = xs[src + i];
+                ys[dst] = ys[src + i];
+                ++dst;
+            }
+        }
+        count = kept;
+        xs.resize((size_t)length * count);
+        ys.resize((size_t)length * count);
+        ++gen;
+    }
+};
+
+#endif
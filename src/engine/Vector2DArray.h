@@ -0,0 +1,84 @@
+#ifndef VECTOR2DARRAY_H
+#define VECTOR2DARRAY_H
+
+#include "Vector2D.h"
+#include <vector>
+#include <cstddef>
+
+static_assert(sizeof(Vector2D) == 2 * sizeof(float), "Vector2D must be two packed floats");
+
+// Contiguous (x, y) float32 pairs. Exposed to Python with the buffer
+// protocol, so it converts to and from (n, 2) NumPy arrays without copying
+// and can be passed anywhere the engine takes points.
+struct Vector2DArray {
+    std::vector<Vector2D> items;
+
+    Vector2DArray() {}
+    explicit Vector2DArray(size_t n) : items(n) {}
+    Vector2DArray(const float* xy, size_t n) : items(n) {
+        for (size_t i = 0; i < n; ++i) items[i] = Vector2D(xy[2 * i], xy[2 * i + 1]);
+    }
+
+    size_t size() const { return items.size(); }
+    Vector2D* data() { return items.data(); }
+    const Vector2D* data() const { return items.data(); }
+    float* floats() { return reinterpret_cast<float*>(items.data()); }
+
+    Vector2DArray operator+(const Vector2DArray& o) const {
+        Vector2DArray r(size());
+        for (size_t i = 0; i < size(); ++i) r.items[i] = items[i] + o.items[i];
+        return r;
+    }
+
+    Vector2DArray operator-(const Vector2DArray& o) const {
+        Vector2DArray r(size());
+        for (size_t i = 0; i < size(); ++i) r.items[i] = items[i] - o.items[i];
+        return r;
+    }
+
+    // Same vector added to / subtracted from every element
+    Vector2DArray operator+(const Vector2D& v) const {
+        Vector2DArray r(size());
+        for (size_t i = 0; i < size(); ++i) r.items[i] = items[i] + v;
+        return r;
+    }
+
+    Vector2DArray operator-(const Vector2D& v) const {
+        Vector2DArray r(size());
+        for (size_t i = 0; i < size(); ++i) r.items[i] = items[i] - v;
+        return r;
+    }
+
+    Vector2DArray operator*(float n) const {
+        Vector2DArray r(size());
+        for (size_t i = 0; i < size(); ++i) r.items[i] = items[i] * n;
+        return r;
+    }
+
+    // Element-wise Vector2D::operator/, so results match it bit for bit
+    Vector2DArray operator/(float n) const {
+        Vector2DArray r(size());
+        for (size_t i = 0; i < size(); ++i) r.items[i] = items[i] / n;
+        return r;
+    }
+
+    std::vector<float> mag() const {
+        std::vector<float> r(size());
+        for (size_t i = 0; i < size(); ++i) r[i] = items[i].mag();
+        return r;
+    }
+
+    Vector2DArray normalized() const {
+        Vector2DArray r(*this);
+        for (auto& v : r.items) v.normalize();
+        return r;
+    }
+
+    Vector2DArray limited(float max) const {
+        Vector2DArray r(*this);
+        for (auto& v : r.items) v.limit(max);
+        return r;
+    }
+};
+
+#endif
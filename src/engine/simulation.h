@@ -2,62 +2,821 @@
 #define SIMULATION_H
 
 #include "Boid.h"
+#include "Vector2DArray.h"
 #include "Grid.h"
+#include "FlowField.h"
+#include "Attractors.h"
+#include "Obstacles.h"
+#include "ScalarField.h"
+#include "NeighborGraph.h"
+#include "SpatialStats.h"
+#include "Trails.h"
+#include "Rewind.h"
+#include "SharedState.h"
+#include "StreamServer.h"
+#include "CommandQueue.h"
+#include "FramePacer.h"
+#include "ThreadTuner.h"
+#include "Tombstones.h"
+#include "RegionPager.h"
+#include "Initializers.h"
 #include <omp.h>
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
 
 class Simulation {
 public:
     std::vector<Boid> boids;
     float width, height;
 
-    Simulation(int count, float w, float h) : width(w), height(h) {
+    // Removed boids stay in `boids` (frozen, skipped by the step) until
+    // compaction, which happens once more than compactThreshold of the rows
+    // are dead or when compact() is called. Snapshots (rewind history,
+    // pickles) carry the bitmap next to the records.
+    Tombstones tombstones;
+    float compactThreshold = 0.25f;
+
+    // Rebuilt at the start of every step; kept as a member so the cell
+    // vectors keep their capacity.
+    Grid grid;
+
+    // Predator position used by step() without arguments; set directly or
+    // through the command queue. Any extra predators are fled from as well.
+    Vector2D predator = Vector2D(-1000.0f, -1000.0f);
+    std::vector<Vector2D> extraPredators;
+    CommandQueue commands;
+    std::atomic<bool> stopRequested;
+
+    // Held for a whole step (drain included) and by the read-only analyses
+    // below that run without the GIL, so a step on another thread (e.g.
+    // run_realtime) can't grow or reallocate `boids` under a query. Those
+    // take the row count their output was sized for and fail if a step
+    // has changed it. Other calls that change the boid array (add_boids,
+    // remove_boids, compact, rewind) must not overlap a step; use the
+    // command queue instead.
+    mutable std::mutex stateMutex;
+
+    FlowField flow;
+    float flowStrength = 1.0f;
+
+    // Limits given to every boid, including ones added later
+    float maxSpeed = 2.5f;
+    float maxForce = 0.15f;
+
+    AttractorSet attractors;
+
+    ObstacleSet obstacles;
+    float obstacleWeight = 3.0f; // scale of the avoidance force on the rim
+
+    TrailBuffer trails;
+
+    RewindBuffer history;
+    uint64_t stepCount = 0;
+
+    SharedStatePublisher publisher;
+    StreamServer streamer;
+
+    // Per-phase thread counts (see ThreadTuner)
+    ThreadTuner tuner;
+
+    // Out-of-core regions (see RegionPager); residency is re-evaluated
+    // every pageInterval steps around the predator and the cameras.
+    RegionPager pager;
+    std::vector<Vector2D> cameras;
+    int pageInterval = 30;
+
+    ScalarField alarm;
+    float alarmDeposit = 0.5f; // added per panicked boid per step
+    float alarmWeight = 2.0f;  // scale of the evade force at unit concentration
+
+    Simulation(int count, float w, float h) : width(w), height(h), grid(w, h, 50.0f), stopRequested(false) {
         for(int i=0; i<count; ++i) boids.emplace_back(rand()%int(w), rand()%int(h));
+        for (auto& b : boids) {
+            b.worldWidth = w;
+            b.worldHeight = h;
+        }
+        tombstones.reset(count);
+    }
+
+    // count boids in a seeded layout instead of rand() positions
+    Simulation(int count, float w, float h, const SpawnSpec& spec) : Simulation(0, w, h) {
+        spawn(spec, count);
+    }
+
+    // Queued commands are applied first, so a queued predator move takes
+    // effect in this step.
+    void step() {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        drain_commands();
+        if (extraPredators.empty()) {
+            advance(&predator, 1);
+            return;
+        }
+        std::vector<Vector2D> all = allPredators();
+        advance(all.data(), static_cast<int>(all.size()));
+    }
+
+    // `predator` followed by extraPredators, as step() hands them over
+    std::vector<Vector2D> allPredators() const {
+        std::vector<Vector2D> all(1, predator);
+        all.insert(all.end(), extraPredators.begin(), extraPredators.end());
+        return all;
+    }
+
+    void step(Vector2D predatorPos) { step(&predatorPos, 1); }
+
+    void step(const Vector2DArray& predatorList) {
+        step(predatorList.data(), static_cast<int>(predatorList.size()));
+    }
+
+    // One step with any number of predators: the first one is handled by
+    // flock() and each further one adds its own flee force.
+    void step(const Vector2D* predators, int predatorCount) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        drain_commands();
+        advance(predators, predatorCount);
     }
 
-    void step(Vector2D predatorPos) {
-        Grid grid(width, height, 50.0f);
+    // The step itself, once the command queue has been drained
+    void advance(const Vector2D* predators, int predatorCount) {
+        const Vector2D offscreen(-1000.0f, -1000.0f);
+        const Vector2D predatorPos = predatorCount > 0 ? predators[0] : offscreen;
+        if (pager.active() && stepCount % pageInterval == 0) page_regions(predators, predatorCount);
+        flow.swapIfPending();
+        const bool hasFlow = flow.active();
+
+        buildGrid();
+
+        int n = static_cast<int>(boids.size());
+        const bool hasAttractors = !attractors.empty();
+        const bool hasObstacles = !obstacles.empty();
+
+        // Small flocks run inline; forking the team would cost more than it saves
+        const int flockThreads = tuner.threadsFor(PHASE_FLOCK, n);
+        // Per-thread scratch is sized by the team asked for, which OpenMP
+        // may shrink but never grow
+        if (hasAttractors) attractors.beginStep(flockThreads);
+
+        // Alarm deposits are rare (only boids inside the panic radius), so
+        // they are collected per thread and applied after the loop instead
+        // of writing the field while other threads sample it.
+        const bool hasAlarm = alarm.active();
+        const bool hasTrails = trails.active();
+        std::vector<std::vector<int>> deposits(hasAlarm ? flockThreads : 0);
+
+        double t0 = omp_get_wtime();
+
+        #pragma omp parallel num_threads(flockThreads) if(flockThreads > 1)
+        {
+            float* eaten = hasAttractors ? attractors.threadSlots(omp_get_thread_num()) : nullptr;
+
+            // Static scheduling: eliminates dynamic scheduling overhead
+            // Each thread gets contiguous chunks for better cache performance
+            #pragma omp for schedule(static)
+            for (int i = 0; i < n; ++i) {
+                if (tombstones.isDead(i)) continue;
+                auto& b = boids[i];
+
+                // Reduced buffer - 64 neighbors is plenty for good flocking
+                Boid* neighborBuffer[64];
+                int found = grid.query(b.pos.x, b.pos.y, neighborBuffer, 64);
+
+                std::vector<Boid*> neighbors(neighborBuffer, neighborBuffer + found);
+
+                b.flock(neighbors, predatorPos);
+                for (int k = 1; k < predatorCount; ++k) b.applyForce(b.flee(predators[k]) * 3.0f);
+
+                if (hasAttractors) {
+                    Vector2D target;
+                    int k = attractors.best(b, target);
+                    if (k >= 0) {
+                        b.applyForce(b.seek(target) * attractors[k].strength);
+                        eaten[k] += attractors.consumeRate;
+                    }
+                }
+
+                if (hasObstacles) b.applyForce(obstacles.avoid(b) * obstacleWeight);
+
+                if (hasAlarm) {
+                    Vector2D grad;
+                    float level = alarm.sample(b.pos.x, b.pos.y, grad);
+                    if (level > 0.01f && grad.magSq() > 0.0f) b.applyForce(b.evade(grad) * (std::min(level, 1.0f) * alarmWeight));
+                    if (inPanicRadius(b.pos, predators, predatorCount)) {
+                        deposits[omp_get_thread_num()].push_back(alarm.cellIndex(b.pos.x, b.pos.y));
+                    }
+                }
+
+                b.prevPos = b.pos;
+                b.update();
+
+                // Currents drift the fish rather than steer them
+                if (hasFlow) b.pos += flow.sample(b.pos.x, b.pos.y) * flowStrength;
+                if (hasObstacles) obstacles.resolve(b);
 
+                // Boundary wrap
+                if (b.pos.x > width) b.pos.x = 0;
+                else if (b.pos.x < 0) b.pos.x = width;
+                if (b.pos.y > height) b.pos.y = 0;
+                else if (b.pos.y < 0) b.pos.y = height;
+
+                if (hasTrails) trails.record(i, b.pos);
+            }
+        }
+
+        tuner.record(PHASE_FLOCK, n, flockThreads, omp_get_wtime() - t0);
+
+        if (hasAttractors) {
+            const long long slots = (long long)attractors.size() * flockThreads;
+            tuned(PHASE_ATTRACT, slots, [&](int threads) { attractors.endStep(threads); });
+        }
+        if (hasTrails) trails.advance();
+
+        ++stepCount;
+        if (history.active()) history.capture(stepCount, boids.data(), n, tombstones);
+        if (publisher.active()) {
+            const int threads = tuner.threadsFor(PHASE_PUBLISH, n);
+            double tp = omp_get_wtime();
+            publisher.publish(stepCount, boids, threads, &tombstones);
+            tuner.record(PHASE_PUBLISH, n, threads, omp_get_wtime() - tp);
+        }
+        if (streamer.active() && streamer.subscriberCount() > 0) {
+            tuned(PHASE_STREAM, n, [&](int threads) { streamer.offer(stepCount, boids, threads); });
+        }
+
+        if (hasAlarm) {
+            for (const auto& list : deposits) {
+                for (int cell : list) alarm.deposit(cell, alarmDeposit);
+            }
+            const long long cells = (long long)alarm.numRows() * alarm.numCols();
+            const int threads = tuner.threadsFor(PHASE_DIFFUSE, cells);
+            double td = omp_get_wtime();
+            alarm.diffuse(threads);
+            tuner.record(PHASE_DIFFUSE, cells, threads, omp_get_wtime() - td);
+        }
+    }
+
+    // Run fn(threads) as one more tuned phase over `items`: the thread count
+    // is picked and the time fed back like the step's own phases, so small
+    // per-step and per-frame loops don't fork the whole team every call.
+    template <typename Fn>
+    void tuned(StepPhase phase, long long items, Fn fn) {
+        const int threads = tuner.threadsFor(phase, items);
+        double t0 = omp_get_wtime();
+        fn(threads);
+        tuner.record(phase, items, threads, omp_get_wtime() - t0);
+    }
+
+    void buildGrid() {
+        grid.clear();
         // Grid population (single-threaded is faster due to better cache locality)
-        for (auto& b : boids) {
-            grid.add(&b);
+        const int n = static_cast<int>(boids.size());
+        for (int i = 0; i < n; ++i) {
+            if (!tombstones.isDead(i)) grid.add(&boids[i]);
         }
+    }
 
+    // Rows in `boids`, read under stateMutex; size the outputs of the
+    // analyses below with it.
+    int row_count() const {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        return static_cast<int>(boids.size());
+    }
+
+    // Grid of the live boids for the analyses below. They run without the
+    // GIL, so they build their own instead of rebuilding `grid`, which a
+    // concurrent query would be using. In large (paged) worlds the grid is
+    // sparse, so this costs the resident boids, not the world area. Call
+    // with stateMutex held.
+    Grid queryGrid() {
+        Grid local(width, height, grid.getCellSize());
+        const int n = static_cast<int>(boids.size());
+        for (int i = 0; i < n; ++i) {
+            if (!tombstones.isDead(i)) local.add(&boids[i]);
+        }
+        return local;
+    }
+
+    // CSR neighbour graph of the current positions; see buildNeighborCSR.
+    // Like the spatial statistics below, this leaves pending removals in
+    // place: rows keep their indices and dead rows have no edges. indptr
+    // holds rows + 1 entries; returns -1 (writing nothing) if a step has
+    // changed the row count since.
+    int64_t neighbor_graph(int rows, int64_t* indptr, int32_t* indices, float* dists, int64_t capacity,
+                           float radius, bool flockNeighbors) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (static_cast<int>(boids.size()) != rows) return -1;
+        Grid local = queryGrid();
+        return buildNeighborCSR(boids, tombstones, local, radius, flockNeighbors, indptr, indices, dists, capacity);
+    }
+
+    // Hop distance of every boid from the seeds over the current neighbour
+    // graph, with the frontier size per hop in sizes. See frontierBFS. Dead
+    // seeds are ignored and dead boids are never reached. hops holds rows
+    // entries; returns false if a step has changed the row count since.
+    bool wavefront(int rows, const std::vector<int>& seeds, int maxHops, float radius, bool flockNeighbors,
+                   int32_t* hops, std::vector<int64_t>& sizes) {
+        std::lock_guard<std::mutex> lock(stateMutex);
         int n = static_cast<int>(boids.size());
-        
-        // Static scheduling: eliminates dynamic scheduling overhead
-        // Each thread gets contiguous chunks for better cache performance
-        #pragma omp parallel for schedule(static)
+        if (n != rows) return false;
+        std::vector<int> live;
+        for (int s : seeds) {
+            if (s >= 0 && s < n && !tombstones.isDead(s)) live.push_back(s);
+        }
+        // Scratch CSR is local too, so concurrent queries share nothing
+        Grid local = queryGrid();
+        std::vector<int64_t> indptr(n + 1);
+        std::vector<int32_t> indices;
+        int64_t nnz = buildNeighborCSR(boids, tombstones, local, radius, flockNeighbors, indptr.data(), indices.data(),
+                                       nullptr, 0);
+        indices.resize(nnz);
+        buildNeighborCSR(boids, tombstones, local, radius, flockNeighbors, indptr.data(), indices.data(), nullptr, nnz);
+        if (flockNeighbors) {
+            // A boid reacts to the neighbours it sees, so the startle travels
+            // along reversed edges of the (directed) flock neighbour lists
+            std::vector<int64_t> indptrT;
+            std::vector<int32_t> indicesT;
+            transposeCSR(n, indptr.data(), indices.data(), indptrT, indicesT);
+            sizes = frontierBFS(n, indptrT.data(), indicesT.data(), live, maxHops, hops);
+        } else {
+            sizes = frontierBFS(n, indptr.data(), indices.data(), live, maxHops, hops);
+        }
+        return true;
+    }
+
+    static bool inPanicRadius(Vector2D p, const Vector2D* predators, int count) {
+        for (int k = 0; k < count; ++k) {
+            if ((p - predators[k]).magSq() < Boid::panicRadiusSq) return true;
+        }
+        return false;
+    }
+
+    // Boids currently inside a predator's panic radius.
+    std::vector<int> panicked(const Vector2D* predators, int count) const {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        std::vector<int> out;
+        for (int i = 0; i < static_cast<int>(boids.size()); ++i) {
+            if (tombstones.isDead(i)) continue;
+            if (inPanicRadius(boids[i].pos, predators, count)) out.push_back(i);
+        }
+        return out;
+    }
+
+    // Spatial statistics of the current positions; see SpatialStats.h.
+    // Per-boid outputs hold rows entries and fail like wavefront.
+    void pair_correlation(const float* edges, int nbins, double* g) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        Grid local = queryGrid();
+        tuned(PHASE_PAIRS, (long long)boids.size(), [&](int threads) {
+            pairCorrelation(boids, tombstones, local, width, height, edges, nbins, g, threads);
+        });
+    }
+
+    bool local_density(int rows, float radius, float* out) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (static_cast<int>(boids.size()) != rows) return false;
+        Grid local = queryGrid();
+        tuned(PHASE_DENSITY, rows, [&](int threads) { localDensity(boids, tombstones, local, radius, out, threads); });
+        return true;
+    }
+
+    bool nearest_neighbor_distances(int rows, float maxRadius, float* out) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (static_cast<int>(boids.size()) != rows) return false;
+        Grid local = queryGrid();
+        tuned(PHASE_NEAREST, rows, [&](int threads) {
+            nearestNeighborDistances(boids, tombstones, local, maxRadius, out, threads);
+        });
+        return true;
+    }
+
+    void set_flow_field(const float* data, int cols, int rows) {
+        flow.load(data, cols, rows, width, height);
+    }
+
+    bool push_flow_frame(const float* data) { return flow.pushFrame(data); }
+
+    void clear_flow_field() { flow.clear(); }
+
+    void set_attractors(const float* data, int count) {
+        attractors.set(data, count, width, height);
+    }
+
+    void clear_attractors() { attractors.clear(); }
+
+    void set_obstacles(const float* data, int count) {
+        obstacles.set(data, count);
+    }
+
+    // false if cols or rows is not positive
+    bool set_alarm_field(int cols, int rows) {
+        return alarm.resize(cols, rows, width, height);
+    }
+
+    void clear_alarm_field() { alarm.clear(); }
+
+    void enable_trails(int length) {
+        if (length > 0) trails.resize(length, static_cast<int>(boids.size()), width, height);
+        else trails.clear();
+    }
+
+    // Keep a compressed history of recent states within maxBytes. Returns
+    // false (and leaves rewind off) if maxBytes can't hold one keyframe of
+    // the current boids.
+    bool enable_rewind(size_t maxBytes, int keyframeInterval) {
+        static_assert(sizeof(Boid) % sizeof(uint32_t) == 0, "Boid must be a whole number of words");
+        if (maxBytes < RewindBuffer::keyframeBytes(static_cast<int>(boids.size()), sizeof(Boid))) return false;
+        history.start(maxBytes, keyframeInterval, sizeof(Boid));
+        history.capture(stepCount, boids.data(), static_cast<int>(boids.size()), tombstones);
+        return true;
+    }
+
+    void disable_rewind() { history.stop(); }
+
+    // Restore the state from `steps` steps ago (or the closest earlier one
+    // still in the history). Returns how many steps were actually rewound.
+    // Only the boid records and stepCount are restored; attractor
+    // capacities, the alarm field, flow buffers and trails keep their
+    // current values.
+    int rewind(int steps) {
+        if (!history.active() || steps <= 0) return 0;
+        uint64_t target = stepCount > (uint64_t)steps ? stepCount - steps : 0;
+        std::vector<uint32_t> raw;
+        int count = 0;
+        uint64_t restoredStep = 0;
+        if (!history.restore(target, raw, count, restoredStep)) return 0;
+
+        load_records(raw.data(), count, raw.data() + (size_t)count * (sizeof(Boid) / sizeof(uint32_t)));
+
+        int rewound = static_cast<int>(stepCount - restoredStep);
+        stepCount = restoredStep;
+        return rewound;
+    }
+
+    // Replace the boids with `count` raw Boid records (a rewind frame or a
+    // pickled state). deadBits is their tombstone bitmap (Tombstones::bits
+    // layout); null means all alive.
+    void load_records(const void* data, int count, const void* deadBits = nullptr) {
+        if (count != static_cast<int>(boids.size())) {
+            boids.resize(count, Boid(0, 0));
+            if (trails.active()) trails.resize(trails.numSlots(), count, width, height);
+        }
+        if (count > 0) std::memcpy(static_cast<void*>(boids.data()), data, (size_t)count * sizeof(Boid));
+        if (deadBits) tombstones.load(deadBits, count);
+        else tombstones.reset(count);
+    }
+
+    // Publish every completed frame to a shared-memory segment (POSIX
+    // only). capacity <= 0 sizes it for the current boid count.
+    bool enable_shared_publisher(const std::string& name, int capacity) {
+        if (capacity <= 0) capacity = static_cast<int>(boids.size());
+        if (!publisher.open(name, static_cast<uint32_t>(capacity), width, height)) return false;
+        publisher.publish(stepCount, boids, 0, &tombstones);
+        return true;
+    }
+
+    void disable_shared_publisher() { publisher.close(); }
+
+    // Serve live frames on "unix:/path" or "tcp:port"; see StreamServer.h.
+    bool start_stream_server(const std::string& address) {
+        return streamer.start(address, width, height);
+    }
+
+    void stop_stream_server() { streamer.stop(); }
+
+    // Positions between the previous and the current step: alpha = 0 is the
+    // previous state, 1 the current one, and values above 1 extrapolate.
+    // Follows wrapped motion across the world edges. out holds rows (x, y)
+    // pairs; returns false if a step has changed the row count since.
+    bool interpolate_positions(int rows, float alpha, float* out) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        int n = static_cast<int>(boids.size());
+        if (n != rows) return false;
+        tuned(PHASE_INTERP, n, [&](int threads) {
+            #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+            for (int i = 0; i < n; ++i) {
+                const Boid& b = boids[i];
+                Vector2D p = b.prevPos + b.wrappedDiff(b.pos, b.prevPos) * alpha;
+                if (p.x >= width) p.x -= width; else if (p.x < 0) p.x += width;
+                if (p.y >= height) p.y -= height; else if (p.y < 0) p.y += height;
+                out[2 * i] = p.x;
+                out[2 * i + 1] = p.y;
+            }
+        });
+        return true;
+    }
+
+    // Everything the GUIs need to draw a frame, in one pass. Any output may
+    // be null. Per boid: head/body/tail pixel coordinates (int32 pairs,
+    // truncated like NumPy's astype), heading angle in radians, a colour
+    // index in [0, colorLevels) from speed / maxSpeed, and a triangle glyph
+    // (tip, left, right) as three int32 pairs. Removed boids get -1
+    // coordinates, which fall outside any screen. Outputs hold rows boids;
+    // returns false if a step has changed the row count since.
+    bool render_geometry(int rows, int32_t* head, int32_t* body, int32_t* tail, float* heading,
+                         uint8_t* color, int colorLevels, int32_t* triangles,
+                         float headLength, float tailLength) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        int n = static_cast<int>(boids.size());
+        if (n != rows) return false;
+        tuned(PHASE_RENDER, n, [&](int threads) {
+            #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+            for (int i = 0; i < n; ++i) {
+                if (tombstones.isDead(i)) {
+                    for (int k = 0; k < 2; ++k) {
+                        if (head) head[2 * i + k] = -1;
+                        if (body) body[2 * i + k] = -1;
+                        if (tail) tail[2 * i + k] = -1;
+                    }
+                    if (heading) heading[i] = 0.0f;
+                    if (color) color[i] = 0;
+                    if (triangles) std::fill(triangles + 6 * i, triangles + 6 * i + 6, -1);
+                    continue;
+                }
+                const Boid& b = boids[i];
+                float speed = b.vel.mag();
+                float inv = 1.0f / std::max(speed, 1.0f);
+                float dx = b.vel.x * inv, dy = b.vel.y * inv;
+
+                if (head) {
+                    head[2 * i] = static_cast<int32_t>(b.pos.x + dx * headLength);
+                    head[2 * i + 1] = static_cast<int32_t>(b.pos.y + dy * headLength);
+                }
+                if (body) {
+                    body[2 * i] = static_cast<int32_t>(b.pos.x);
+                    body[2 * i + 1] = static_cast<int32_t>(b.pos.y);
+                }
+                if (tail) {
+                    tail[2 * i] = static_cast<int32_t>(b.pos.x - dx * tailLength);
+                    tail[2 * i + 1] = static_cast<int32_t>(b.pos.y - dy * tailLength);
+                }
+                if (heading) heading[i] = std::atan2(b.vel.y, b.vel.x);
+                if (color) {
+                    int c = static_cast<int>(speed / b.maxSpeed * (colorLevels - 1) + 0.5f);
+                    color[i] = static_cast<uint8_t>(std::min(std::max(c, 0), colorLevels - 1));
+                }
+                if (triangles) {
+                    float half = tailLength * 0.5f;
+                    int32_t* t = triangles + 6 * i;
+                    t[0] = static_cast<int32_t>(b.pos.x + dx * headLength);
+                    t[1] = static_cast<int32_t>(b.pos.y + dy * headLength);
+                    t[2] = static_cast<int32_t>(b.pos.x - dx * tailLength - dy * half);
+                    t[3] = static_cast<int32_t>(b.pos.y - dy * tailLength + dx * half);
+                    t[4] = static_cast<int32_t>(b.pos.x - dx * tailLength + dy * half);
+                    t[5] = static_cast<int32_t>(b.pos.y - dy * tailLength - dx * half);
+                }
+            }
+        });
+        return true;
+    }
+
+    // Step at a fixed rate, paced in C++, calling callback after every
+    // callbackEveryN steps (render boundaries). Stops when the callback
+    // returns false, after maxSteps (if > 0) or on stop_realtime(). A stop
+    // requested before the run starts ends it at once; the request is
+    // cleared on the way out (also when the callback throws). The
+    // predator is taken from the `predator` member / command queue.
+    // Returns the number of steps run.
+    long long run_realtime(double hz, int callbackEveryN, const std::function<bool()>& callback,
+                           long long maxSteps) {
+        struct ClearStop {
+            std::atomic<bool>& flag;
+            ~ClearStop() { flag.store(false); }
+        } clearStop = { stopRequested };
+        if (hz <= 0.0) return 0;
+        if (callbackEveryN < 1) callbackEveryN = 1;
+
+        FramePacer pacer(hz);
+        pacer.start();
+        long long steps = 0;
+        while (!stopRequested.load() && (maxSteps <= 0 || steps < maxSteps)) {
+            step();
+            ++steps;
+            if (callback && steps % callbackEveryN == 0 && !callback()) break;
+            pacer.wait();
+        }
+        return steps;
+    }
+
+    // Safe to call from any thread
+    void stop_realtime() { stopRequested.store(true); }
+
+    // Apply everything queued since the last step (step boundaries only)
+    void drain_commands() {
+        Command c;
+        while (commands.pop(c)) {
+            switch (c.type) {
+                case Command::SET_PREDATOR: predator = Vector2D(c.x, c.y); break;
+                case Command::REMOVE_BOIDS: remove_boids(c.indices); break;
+                case Command::ADD_BOIDS: add_boids(c.rows.data(), static_cast<int>(c.rows.size() / 4), 4); break;
+                case Command::SET_PARAM: set_param(c.param, c.value); break;
+            }
+        }
+    }
+
+    void set_param(SimParam param, float value) {
+        switch (param) {
+            case PARAM_MAX_SPEED:
+                maxSpeed = value;
+                for (auto& b : boids) b.maxSpeed = value;
+                break;
+            case PARAM_MAX_FORCE:
+                maxForce = value;
+                for (auto& b : boids) b.maxForce = value;
+                break;
+            case PARAM_FLOW_STRENGTH: flowStrength = value; break;
+            case PARAM_ALARM_DEPOSIT: alarmDeposit = value; break;
+            case PARAM_ALARM_WEIGHT: alarmWeight = value; break;
+            case PARAM_CONSUME_RATE: attractors.consumeRate = value; break;
+        }
+    }
+
+    // Append boids from rows of (x, y) (stride 2, random heading) or
+    // (x, y, vx, vy) (stride 4). While paging, boids that land in a
+    // paged-out region are appended to its file instead of memory.
+    void add_boids(const float* rows, int count, int stride) { insert_boids(rows, count, stride, false); }
+
+    // Append count boids laid out by spec (see Initializers.h). Layouts
+    // other than Poisson are generated in chunks, so with paging enabled a
+    // world larger than memory is spawned straight into its page files.
+    void spawn(const SpawnSpec& spec, int count) {
+        const int chunk = spec.layout == SPAWN_POISSON ? std::max(count, 1) : 1 << 16;
+        std::vector<float> rows;
+        for (int first = 0; first < count; first += chunk) {
+            generateBoids(spec, count, width, height, rows, first, chunk);
+            // Wander starts along the heading rather than from rand()
+            insert_boids(rows.data(), static_cast<int>(rows.size() / 4), 4, true);
+        }
+    }
+
+    // Page out every region no focus point is near, and page in the ones
+    // that have come into range. Boids that wandered into a paged-out
+    // region follow it to disk.
+    void page_regions(const Vector2D* predators, int predatorCount) {
+        std::vector<Vector2D> focus(cameras);
+        focus.insert(focus.end(), predators, predators + predatorCount);
+        std::vector<char> want;
+        pager.wanted(focus, want);
+
+        compact(); // dead boids are dropped, not written out
+        int n = static_cast<int>(boids.size());
+        std::map<int, std::vector<int>> leaving;
         for (int i = 0; i < n; ++i) {
-            auto& b = boids[i];
-            
-            // Reduced buffer - 64 neighbors is plenty for good flocking
-            Boid* neighborBuffer[64]; 
-            int found = grid.query(b.pos.x, b.pos.y, neighborBuffer, 64);
+            int r = pager.regionOf(boids[i].pos);
+            if (!want[r]) leaving[r].push_back(i);
+        }
 
-            std::vector<Boid*> neighbors(neighborBuffer, neighborBuffer + found);
+        std::vector<char> keep(n, 1);
+        bool anyLeft = false;
+        std::vector<Boid> group;
+        for (int r = 0; r < pager.numRegions(); ++r) {
+            auto it = leaving.find(r);
+            if (want[r] || (it == leaving.end() && !pager.isResident(r))) continue;
+            group.clear();
+            if (it != leaving.end()) {
+                for (int i : it->second) group.push_back(boids[i]);
+            }
+            if (!pager.pageOut(r, group)) continue; // stay resident, retry later
+            if (it != leaving.end()) {
+                for (int i : it->second) keep[i] = 0;
+                anyLeft = true;
+            }
+        }
+        if (anyLeft) {
+            int kept = 0;
+            for (int i = 0; i < n; ++i) {
+                if (keep[i]) boids[kept++] = boids[i];
+            }
+            boids.erase(boids.begin() + kept, boids.end());
+            if (trails.active()) trails.compact(keep);
+            tombstones.reset(kept);
+        }
 
-            b.flock(neighbors, predatorPos);
-            b.update();
+        size_t before = boids.size();
+        for (int r = 0; r < pager.numRegions(); ++r) {
+            if (want[r] && !pager.isResident(r)) pager.pageIn(r, boids);
+        }
+        paged_in(before);
+    }
 
-            // Boundary wrap
-            if (b.pos.x > width) b.pos.x = 0;
-            else if (b.pos.x < 0) b.pos.x = width;
-            if (b.pos.y > height) b.pos.y = 0;
-            else if (b.pos.y < 0) b.pos.y = height;
+    // add_boids/spawn; headingWander starts the wander along the heading.
+    void insert_boids(const float* rows, int count, int stride, bool headingWander) {
+        if (count <= 0) return;
+        std::vector<Vector2D> added;
+        std::map<int, std::vector<Boid>> outOfCore;
+        if (!pager.active()) {
+            added.reserve(count);
+            boids.reserve(boids.size() + count);
         }
+        for (int k = 0; k < count; ++k) {
+            const float* r = rows + (size_t)k * stride;
+            Boid b(r[0], r[1]);
+            b.worldWidth = width;
+            b.worldHeight = height;
+            b.maxSpeed = maxSpeed;
+            b.maxForce = maxForce;
+            if (stride >= 4) b.vel = Vector2D(r[2], r[3]);
+            if (headingWander) b.wanderAngle = std::atan2(b.vel.y, b.vel.x);
+            if (pager.active()) {
+                int region = pager.regionOf(b.pos);
+                if (!pager.isResident(region)) {
+                    outOfCore[region].push_back(b);
+                    continue;
+                }
+            }
+            boids.push_back(b);
+            added.push_back(b.pos);
+        }
+        for (auto& group : outOfCore) {
+            if (pager.pageOut(group.first, group.second)) continue;
+            // Write failed: keep them resident; the next paging pass retries
+            for (const Boid& b : group.second) {
+                boids.push_back(b);
+                added.push_back(b.pos);
+            }
+        }
+        if (trails.active()) trails.extend(added);
+        tombstones.grow(static_cast<int>(boids.size()));
+    }
+
+    // Side buffers for boids appended by the pager from index `before` on.
+    void paged_in(size_t before) {
+        if (boids.size() == before) return;
+        std::vector<Vector2D> added;
+        for (size_t i = before; i < boids.size(); ++i) added.push_back(boids[i].pos);
+        if (trails.active()) trails.extend(added);
+        tombstones.grow(static_cast<int>(boids.size()));
+    }
+
+    // Run worlds larger than memory: boids in regions of regionSize with no
+    // predator or camera within activeRadius are kept in files under
+    // directory and frozen until one comes near.
+    bool enable_paging(const std::string& directory, float regionSize, float activeRadius, int interval) {
+        if (!disable_paging()) return false;
+        if (!pager.start(directory, width, height, regionSize, activeRadius)) return false;
+        pageInterval = std::max(1, interval);
+        std::vector<Vector2D> all = allPredators();
+        page_regions(all.data(), static_cast<int>(all.size()));
+        return true;
+    }
+
+    // Bring every region back into memory and stop paging. Returns false,
+    // with paging left on and the unread files kept, if a region can't be
+    // read back.
+    bool disable_paging() {
+        if (!pager.active()) return true;
+        size_t before = boids.size();
+        bool ok = true;
+        for (int r = 0; r < pager.numRegions(); ++r) {
+            if (!pager.isResident(r)) ok = pager.pageIn(r, boids) && ok;
+        }
+        paged_in(before);
+        if (ok) pager.stop();
+        return ok;
     }
 
+    // Extra focus points (x, y) that keep regions resident.
+    void set_cameras(const float* xy, int count) {
+        cameras.clear();
+        for (int i = 0; i < count; ++i) cameras.emplace_back(xy[2 * i], xy[2 * i + 1]);
+    }
+
+    // Tombstone the given boids: O(1) each, indices stay valid. Compacts
+    // once the dead fraction passes compactThreshold.
     void remove_boids(const std::vector<int>& indices) {
-        // Sort indices in descending order to remove from back to front
-        std::vector<int> sorted_indices = indices;
-        std::sort(sorted_indices.begin(), sorted_indices.end(), std::greater<int>());
+        int n = static_cast<int>(boids.size());
+        for (int idx : indices) {
+            if (idx < 0 || idx >= n || !tombstones.kill(idx)) continue;
+            boids[idx].prevPos = boids[idx].pos; // stays put in interpolated frames
+        }
+        if (tombstones.deadCount() > compactThreshold * n) compact();
+    }
 
-        for (int idx : sorted_indices) {
-            if (idx >= 0 && idx < static_cast<int>(boids.size())) {
-                boids.erase(boids.begin() + idx);
-            }
+    // Drop the tombstoned boids now; renumbers the survivors and
+    // invalidates views of the boid array. If remap is given it receives
+    // the new index of every old row (-1 for dropped ones), or stays empty
+    // when nothing was dropped.
+    void compact(std::vector<int>* remap = nullptr) {
+        if (remap) remap->clear();
+        if (tombstones.deadCount() == 0) return;
+        std::vector<char> keep;
+        tombstones.keepMask(keep);
+        int n = static_cast<int>(boids.size());
+        if (remap) remap->assign(n, -1);
+
+        // Single compaction pass instead of one erase per index
+        int kept = 0;
+        for (int i = 0; i < n; ++i) {
+            if (!keep[i]) continue;
+            if (remap) (*remap)[i] = kept;
+            boids[kept++] = boids[i];
         }
+        boids.erase(boids.begin() + kept, boids.end());
+
+        if (trails.active()) trails.compact(keep);
+        tombstones.reset(kept);
     }
 };
 
@@ -0,0 +1,167 @@
+// Headless scenario runner: loads a scenario file (see Scenario.h), runs
+// it to completion with no Python in the loop and writes the recordings.
+//
+//   boid_run SCENARIO [--steps N] [--seed S] [--out DIR] [--quiet]
+//
+// --seed replaces the world seed, so a sweep can launch one file many
+// times. Record paths are relative to --out (default: current directory).
+#include "Scenario.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <chrono>
+
+static void usage() {
+    std::fprintf(stderr, "usage: boid_run SCENARIO [--steps N] [--seed S] [--out DIR] [--quiet]\n");
+}
+
+// Whole-string integer >= 0, as the scenario parser reads them
+static bool parseCount(const char* s, long long& out) {
+    char* end = nullptr;
+    errno = 0;
+    long long n = std::strtoll(s, &end, 10);
+    if (end == s || *end != '\0' || errno == ERANGE || n < 0) return false;
+    out = n;
+    return true;
+}
+
+static std::string joinPath(const std::string& dir, const std::string& file) {
+    if (dir.empty() || file.empty() || file[0] == '/') return file;
+    return dir.back() == '/' ? dir + file : dir + "/" + file;
+}
+
+// Trajectory frames: CSV rows of step,id,x,y,vx,vy, or binary frames of
+// (uint64 step, uint32 rows, rows x (int32 id, float32 x, y, vx, vy))
+// after an 8-byte "BOIDREC1" magic. Dead rows are skipped in both.
+static void writeFrame(std::FILE* f, bool binary, const Simulation& sim) {
+    const int n = static_cast<int>(sim.boids.size());
+    if (binary) {
+        uint64_t step = sim.stepCount;
+        uint32_t rows = static_cast<uint32_t>(sim.tombstones.aliveCount());
+        std::fwrite(&step, sizeof(step), 1, f);
+        std::fwrite(&rows, sizeof(rows), 1, f);
+    }
+    for (int i = 0; i < n; ++i) {
+        if (sim.tombstones.isDead(i)) continue;
+        const Boid& b = sim.boids[i];
+        if (binary) {
+            int32_t id = i;
+            float v[4] = { b.pos.x, b.pos.y, b.vel.x, b.vel.y };
+            std::fwrite(&id, sizeof(id), 1, f);
+            std::fwrite(v, sizeof(float), 4, f);
+        } else {
+            std::fprintf(f, "%llu,%d,%.3f,%.3f,%.4f,%.4f\n", (unsigned long long)sim.stepCount, i, b.pos.x, b.pos.y,
+                         b.vel.x, b.vel.y);
+        }
+    }
+}
+
+// Polarization (length of the mean heading, 1 = all aligned) and mean speed
+static void writeStats(std::FILE* f, const Simulation& sim, double elapsedMs) {
+    double hx = 0.0, hy = 0.0, speed = 0.0;
+    int alive = 0;
+    for (size_t i = 0; i < sim.boids.size(); ++i) {
+        if (sim.tombstones.isDead(static_cast<int>(i))) continue;
+        const Vector2D& v = sim.boids[i].vel;
+        float m = v.mag();
+        if (m > 0.0f) {
+            hx += v.x / m;
+            hy += v.y / m;
+        }
+        speed += m;
+        ++alive;
+    }
+    double pol = alive ? std::sqrt(hx * hx + hy * hy) / alive : 0.0;
+    std::fprintf(f, "%llu,%d,%.5f,%.5f,%.1f\n", (unsigned long long)sim.stepCount, alive, pol,
+                 alive ? speed / alive : 0.0, elapsedMs);
+}
+
+int main(int argc, char** argv) {
+    const char* file = nullptr;
+    const char* outDir = "";
+    long long steps = -1;
+    long long seed = -1;
+    bool quiet = false;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--steps") && hasValue && parseCount(argv[i + 1], steps)) ++i;
+        else if (!std::strcmp(argv[i], "--seed") && hasValue && parseCount(argv[i + 1], seed)) ++i;
+        else if (!std::strcmp(argv[i], "--out") && hasValue) outDir = argv[++i];
+        else if (!std::strcmp(argv[i], "--quiet")) quiet = true;
+        else if (argv[i][0] != '-' && !file) file = argv[i];
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (!file) {
+        usage();
+        return 2;
+    }
+
+    Scenario sc;
+    try {
+        std::ifstream in(file);
+        if (!in) throw std::runtime_error(std::string("cannot open ") + file);
+        sc = parseScenario(in, file);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "boid_run: %s\n", e.what());
+        return 2;
+    }
+    if (steps >= 0) sc.steps = steps;
+    if (seed >= 0) sc.seed = static_cast<uint64_t>(seed);
+
+    // Boid headings from add_boids and the wander noise still come from
+    // rand(); seeding it makes single-threaded runs repeatable.
+    std::srand(static_cast<unsigned>(sc.seed));
+    std::unique_ptr<Simulation> sim = buildSimulation(sc);
+
+    std::FILE* rec = nullptr;
+    std::FILE* stats = nullptr;
+    const bool binary = sc.recordFormat == "binary";
+    if (!sc.recordPath.empty()) {
+        std::string path = joinPath(outDir, sc.recordPath);
+        rec = std::fopen(path.c_str(), binary ? "wb" : "w");
+        if (!rec) {
+            std::fprintf(stderr, "boid_run: cannot write %s\n", path.c_str());
+            return 1;
+        }
+        if (binary) std::fwrite("BOIDREC1", 1, 8, rec);
+        else std::fprintf(rec, "step,id,x,y,vx,vy\n");
+    }
+    if (!sc.statsPath.empty()) {
+        std::string path = joinPath(outDir, sc.statsPath);
+        stats = std::fopen(path.c_str(), "w");
+        if (!stats) {
+            std::fprintf(stderr, "boid_run: cannot write %s\n", path.c_str());
+            if (rec) std::fclose(rec);
+            return 1;
+        }
+        std::fprintf(stats, "step,alive,polarization,mean_speed,elapsed_ms\n");
+    }
+
+    std::vector<Vector2D> predators(sc.predators.size());
+    auto t0 = std::chrono::steady_clock::now();
+    auto elapsedMs = [&]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    };
+
+    for (long long s = 0; s < sc.steps; ++s) {
+        for (size_t k = 0; k < predators.size(); ++k) predators[k] = sc.predators[k].advance(sim->stepCount, *sim);
+        sim->step(predators.data(), static_cast<int>(predators.size()));
+        if (sim->stepCount % sc.recordEvery == 0) {
+            if (rec) writeFrame(rec, binary, *sim);
+            if (stats) writeStats(stats, *sim, elapsedMs());
+        }
+    }
+
+    double ms = elapsedMs();
+    if (rec) std::fclose(rec);
+    if (stats) std::fclose(stats);
+    if (!quiet) {
+        std::printf("%s: %lld steps, %d boids, %.1f ms (%.3f ms/step)\n", file, sc.steps, sim->tombstones.aliveCount(),
+                    ms, sc.steps > 0 ? ms / sc.steps : 0.0);
+    }
+    return 0;
+}
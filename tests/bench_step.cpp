@@ -0,0 +1,75 @@
+// Native step benchmark, and the training run for PGO builds: the GUI's
+// workload (a moving predator, per-frame state reads, occasional
+// add/remove) driven through the C ABI.
+//
+//   bench_step [boids=5000] [steps=1000]
+#include "boid_engine_c.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+int main(int argc, char** argv) {
+    const float WIDTH = 1200.0f, HEIGHT = 800.0f;
+    const int boidCount = argc > 1 ? std::atoi(argv[1]) : 5000;
+    const int steps = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+    std::srand(1234);
+    BoidSim* sim = boid_sim_create(boidCount, WIDTH, HEIGHT);
+    if (!sim) {
+        std::fprintf(stderr, "create failed: %s\n", boid_last_error());
+        return 1;
+    }
+
+    std::vector<double> ms;
+    ms.reserve(steps);
+    std::vector<float> added;
+    std::vector<int32_t> removed;
+    double checksum = 0.0;
+
+    for (int s = 0; s < steps; ++s) {
+        auto t0 = std::chrono::steady_clock::now();
+
+        // Predator circling the middle of the world
+        float a = s * 0.02f;
+        float predator[2] = { WIDTH / 2 + 250.0f * std::cos(a), HEIGHT / 2 + 250.0f * std::sin(a) };
+        boid_sim_set_predators(sim, predator, 1);
+        boid_sim_step(sim);
+
+        // What a renderer reads every frame
+        BoidStateView v;
+        boid_sim_state_view(sim, &v);
+        for (int i = 0; i < v.count; ++i) checksum += v.x[i * v.stride] + v.vy[i * v.stride];
+
+        // Churn: a few boids leave and as many arrive
+        if (s % 100 == 99) {
+            int n = boid_sim_count(sim);
+            removed.clear();
+            added.clear();
+            for (int k = 0; k < 50; ++k) {
+                if (n > 0) removed.push_back(std::rand() % n);
+                added.push_back(static_cast<float>(std::rand() % static_cast<int>(WIDTH)));
+                added.push_back(static_cast<float>(std::rand() % static_cast<int>(HEIGHT)));
+            }
+            boid_sim_remove(sim, removed.data(), static_cast<int32_t>(removed.size()));
+            boid_sim_add(sim, added.data(), 50, 2);
+        }
+
+        ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+    }
+
+    // Skip the first tenth (caches, thread pool, tuner probing)
+    std::vector<double> steady(ms.begin() + ms.size() / 10, ms.end());
+    std::sort(steady.begin(), steady.end());
+    double mean = 0.0;
+    for (double t : steady) mean += t;
+    mean /= steady.empty() ? 1 : steady.size();
+    double median = steady.empty() ? 0.0 : steady[steady.size() / 2];
+
+    std::printf("boids=%d steps=%d  mean %.3f ms/step  median %.3f ms/step  (checksum %.0f)\n",
+                boidCount, steps, mean, median, checksum);
+    boid_sim_destroy(sim);
+    return 0;
+}
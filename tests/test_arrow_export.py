@@ -0,0 +1,66 @@
+"""
+Import the Arrow C Data Interface export with pyarrow and check the
+schema, the values and the null rows of removed boids.
+Skipped when pyarrow is not installed.
+"""
+import sys
+import numpy as np
+
+
+def test_arrow_export_imports_in_pyarrow():
+    import boid_engine
+    import pyarrow as pa
+
+    BOID_COUNT = 500
+
+    print(f"\n{'='*60}")
+    print(f"Arrow Export Test - {BOID_COUNT} boids")
+    print(f"{'='*60}\n")
+
+    sim = boid_engine.Simulation(BOID_COUNT, 1200.0, 800.0)
+    sim.compact_threshold = 1.0
+    for _ in range(5):
+        sim.step(boid_engine.Vector2D(600.0, 400.0))
+    sim.remove_boids([3, 250])
+
+    batch = pa.record_batch(sim)
+    expected = pa.schema([("id", pa.int32()), ("x", pa.float32()), ("y", pa.float32()),
+                          ("vx", pa.float32()), ("vy", pa.float32())])
+    schema_ok = batch.schema.equals(expected) and batch.num_rows == BOID_COUNT
+    print(f"  {'✓' if schema_ok else '✗'} Schema {batch.schema.names}, {batch.num_rows} rows")
+
+    state = sim.get_full_state()
+    x = batch.column("x").to_numpy(zero_copy_only=False)
+    alive = np.ones(BOID_COUNT, dtype=bool)
+    alive[[3, 250]] = False
+    values_ok = (np.array_equal(x[alive], state[alive, 0])
+                 and np.array_equal(batch.column("id").to_numpy(zero_copy_only=False)[alive],
+                                    np.arange(BOID_COUNT)[alive]))
+    print(f"  {'✓' if values_ok else '✗'} Columns match get_full_state()")
+
+    nulls_ok = all(batch.column(k).null_count == 2 for k in range(5)) and \
+        batch.column("x").is_null().to_pylist()[3]
+    print(f"  {'✓' if nulls_ok else '✗'} Removed boids are null rows")
+
+    table = pa.table(sim)
+    stream_ok = table.num_rows == BOID_COUNT and table.column("vy").null_count == 2
+    print(f"  {'✓' if stream_ok else '✗'} Stream export reads as a table")
+
+    return schema_ok and values_ok and nulls_ok and stream_ok
+
+
+if __name__ == "__main__":
+    try:
+        import boid_engine
+    except ImportError:
+        print("ERROR: boid_engine module not found!")
+        print("Please build the module first with: pip install .")
+        sys.exit(1)
+    try:
+        import pyarrow
+    except ImportError:
+        print("pyarrow not installed, skipping the Arrow export test")
+        sys.exit(0)
+
+    ok = test_arrow_export_imports_in_pyarrow()
+    sys.exit(0 if ok else 1)
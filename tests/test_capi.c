@@ -0,0 +1,68 @@
+/* Drives the engine through the C ABI only, as an FFI host would. */
+#include "boid_engine_c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static int failures = 0;
+
+static void check(int ok, const char* what) {
+    printf("  %-48s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) ++failures;
+}
+
+int main(void) {
+    const int BOID_COUNT = 1000;
+    BoidSim* sim;
+    BoidStateView view;
+    float predators[4] = { 300.0f, 200.0f, 900.0f, 600.0f };
+    float added[8] = { 10.0f, 10.0f, 1.0f, 0.0f, 20.0f, 20.0f, 0.0f, 1.0f };
+    int32_t dead[2] = { 0, 5 };
+    float* state;
+    uint8_t* mask;
+    int i, n, same = 1, alive = 0;
+
+    printf("C ABI test - %d boids\n", BOID_COUNT);
+    check(boid_abi_version() == BOID_ENGINE_C_ABI_VERSION, "ABI version matches the header");
+
+    check(boid_sim_create(-1, 100.0f, 100.0f) == NULL, "bad arguments are refused");
+    sim = boid_sim_create(BOID_COUNT, 1200.0f, 800.0f);
+    check(sim != NULL, "create");
+    if (!sim) return 1;
+
+    check(boid_sim_set_predators(sim, predators, 2) == BOID_OK, "set two predators");
+    check(boid_sim_step(sim) == BOID_OK, "step");
+    check(boid_sim_step_n(sim, 20) == BOID_OK && boid_sim_step_count(sim) == 21, "step_n");
+    check(boid_sim_step_n(sim, -1) == BOID_ERR_ARGUMENT && boid_last_error()[0] != '\0',
+          "bad step count reports an error");
+
+    check(boid_sim_add(sim, added, 2, 4) == BOID_OK && boid_sim_count(sim) == BOID_COUNT + 2, "add");
+    check(boid_sim_remove(sim, dead, 2) == BOID_OK && boid_sim_alive_count(sim) == BOID_COUNT, "remove");
+
+    /* The view reads the engine's memory; the copy must agree with it */
+    n = boid_sim_count(sim);
+    state = (float*)malloc(sizeof(float) * 4 * n);
+    mask = (uint8_t*)malloc(n);
+    check(boid_sim_get_state(sim, state, n - 1) == BOID_ERR_ARGUMENT, "short buffer is refused");
+    check(boid_sim_get_state(sim, state, n) == BOID_OK, "get_state");
+    check(boid_sim_state_view(sim, &view) == BOID_OK && view.count == n, "state view");
+    for (i = 0; i < n; ++i) {
+        if (view.x[i * view.stride] != state[i * 4 + 0] || view.y[i * view.stride] != state[i * 4 + 1] ||
+            view.vx[i * view.stride] != state[i * 4 + 2] || view.vy[i * view.stride] != state[i * 4 + 3])
+            same = 0;
+    }
+    check(same, "view matches the copy");
+    check(view.x[(n - 1) * view.stride] == 20.0f, "added rows are at the end");
+
+    check(boid_sim_alive_mask(sim, mask, n) == BOID_OK, "alive mask");
+    for (i = 0; i < n; ++i) alive += mask[i];
+    check(alive == BOID_COUNT && mask[0] == 0 && mask[5] == 0, "mask flags the removed rows");
+
+    check(boid_sim_compact(sim) == BOID_OK && boid_sim_count(sim) == BOID_COUNT, "compact");
+
+    free(state);
+    free(mask);
+    boid_sim_destroy(sim);
+    printf("%s\n", failures == 0 ? "PASSED" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+"""
+Check the DLPack export and protocol-5 pickling: np.from_dlpack(sim)
+aliases the boid state, pickles round-trip with and without out-of-band
+buffers, and _restore_simulation rejects buffers of the wrong size.
+"""
+import pickle
+import sys
+import numpy as np
+
+
+def test_dlpack_and_pickle():
+    import boid_engine
+
+    BOID_COUNT = 300
+    predator = boid_engine.Vector2D(600.0, 400.0)
+
+    print(f"\n{'='*60}")
+    print(f"DLPack and Pickle Test - {BOID_COUNT} boids")
+    print(f"{'='*60}\n")
+
+    sim = boid_engine.Simulation(BOID_COUNT, 1200.0, 800.0)
+    sim.compact_threshold = 1.0
+    for _ in range(10):
+        sim.step(predator)
+    sim.remove_boids([7])
+
+    # DLPack: (n, 4) float32 over the boid records (13-float row stride)
+    view = np.from_dlpack(sim)
+    state = sim.get_full_state()
+    dlpack_ok = (view.shape == (BOID_COUNT, 4) and view.dtype == np.float32
+                 and np.array_equal(view, state) and np.shares_memory(view, state))
+    sim.step(predator)
+    shared_ok = np.array_equal(view, sim.get_full_state())
+    print(f"  {'✓' if dlpack_ok else '✗'} from_dlpack shape, dtype and values")
+    print(f"  {'✓' if shared_ok else '✗'} from_dlpack shares memory with the engine")
+    del view, state
+
+    def same(a, b):
+        return (np.array_equal(a.get_full_state(), b.get_full_state())
+                and a.step_count == b.step_count and a.alive_count == b.alive_count
+                and np.array_equal(a.alive_mask(), b.alive_mask()))
+
+    in_band = pickle.loads(pickle.dumps(sim, protocol=5))
+    buffers = []
+    data = pickle.dumps(sim, protocol=5, buffer_callback=buffers.append)
+    out_of_band = pickle.loads(data, buffers=buffers)
+    legacy = pickle.loads(pickle.dumps(sim, protocol=4))
+    pickle_ok = same(sim, in_band) and same(sim, legacy) and in_band.alive_count == BOID_COUNT - 1
+    oob_ok = len(buffers) == 1 and same(sim, out_of_band)
+    print(f"  {'✓' if pickle_ok else '✗'} Protocol 5 and 4 pickles round-trip")
+    print(f"  {'✓' if oob_ok else '✗'} Out-of-band buffer round-trips")
+
+    # The restored copy owns its records: stepping it leaves sim alone
+    before = sim.get_full_state().copy()
+    out_of_band.step(predator)
+    independent_ok = np.array_equal(before, sim.get_full_state())
+    print(f"  {'✓' if independent_ok else '✗'} Restored simulation owns its boids")
+
+    restore, (width, height, records, params, dead) = sim.__reduce_ex__(4)
+    rejected = 0
+    for bad_records, bad_dead in ((records[:-1], dead), (records + b"\0", dead), (records, dead + b"\0")):
+        try:
+            restore(width, height, bad_records, params, bad_dead)
+        except ValueError:
+            rejected += 1
+    reject_ok = rejected == 3
+    print(f"  {'✓' if reject_ok else '✗'} _restore_simulation rejects wrong sizes ({rejected}/3)")
+
+    return dlpack_ok and shared_ok and pickle_ok and oob_ok and independent_ok and reject_ok
+
+
+if __name__ == "__main__":
+    try:
+        import boid_engine
+    except ImportError:
+        print("ERROR: boid_engine module not found!")
+        print("Please build the module first with: pip install .")
+        sys.exit(1)
+
+    ok = test_dlpack_and_pickle()
+    sys.exit(0 if ok else 1)
@@ -0,0 +1,588 @@
+// Native smoke test: the engine used from C++ through the CMake target,
+// without Python.
+#include "simulation.h"
+#include "Scenario.h"
+#include "ArrowExport.h"
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <sstream>
+#include <cstring>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf("  %-48s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) ++failures;
+}
+
+// Stream client side for the loopback test: read exactly len bytes,
+// waiting up to timeoutMs for each chunk; false on timeout or hang-up.
+static bool readExactly(int fd, uint8_t* buf, size_t len, int timeoutMs) {
+    size_t got = 0;
+    while (got < len) {
+        pollfd p = { fd, POLLIN, 0 };
+        if (poll(&p, 1, timeoutMs) <= 0) return false;
+        ssize_t r = recv(fd, buf + got, len - got, 0);
+        if (r <= 0) return false;
+        got += static_cast<size_t>(r);
+    }
+    return true;
+}
+
+struct StreamFrame {
+    uint64_t step;
+    uint32_t count;
+    uint8_t kind;
+    std::vector<uint8_t> payload;
+};
+
+static bool readFrame(int fd, StreamFrame& f, int timeoutMs) {
+    uint8_t h[32];
+    if (!readExactly(fd, h, 32, timeoutMs)) return false;
+    uint32_t magic, bytes;
+    std::memcpy(&magic, h, 4);
+    std::memcpy(&bytes, h + 4, 4);
+    std::memcpy(&f.step, h + 8, 8);
+    std::memcpy(&f.count, h + 16, 4);
+    f.kind = h[20];
+    if (magic != StreamServer::FRAME_MAGIC) return false;
+    f.payload.resize(bytes);
+    return bytes == 0 || readExactly(fd, f.payload.data(), bytes, timeoutMs);
+}
+
+// Apply a key (0) or delta (1) frame to the client's copy of the
+// quantised positions; false if the payload doesn't decode exactly.
+static bool applyFrame(const StreamFrame& f, std::vector<uint16_t>& q) {
+    const size_t values = (size_t)f.count * 2;
+    if (f.kind == 0) {
+        if (f.payload.size() != values * 2) return false;
+        q.resize(values);
+        std::memcpy(q.data(), f.payload.data(), f.payload.size());
+        return true;
+    }
+    if (f.kind != 1 || q.size() != values) return false;
+    size_t at = 0;
+    for (size_t k = 0; k < values; ++k) {
+        uint32_t v = 0;
+        for (int shift = 0;; shift += 7) {
+            if (at >= f.payload.size() || shift > 28) return false;
+            uint8_t b = f.payload[at++];
+            v |= static_cast<uint32_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) break;
+        }
+        int32_t d = static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+        q[k] = static_cast<uint16_t>(q[k] + d);
+    }
+    return at == f.payload.size();
+}
+
+// The server's quantisation of the current positions
+static std::vector<uint16_t> quantised(const Simulation& sim) {
+    std::vector<uint16_t> q;
+    for (const Boid& b : sim.boids) {
+        q.push_back(static_cast<uint16_t>(std::min(std::max(b.pos.x * (65535.0f / sim.width), 0.0f), 65535.0f) + 0.5f));
+        q.push_back(static_cast<uint16_t>(std::min(std::max(b.pos.y * (65535.0f / sim.height), 0.0f), 65535.0f) + 0.5f));
+    }
+    return q;
+}
+
+int main() {
+    const float WIDTH = 1200.0f, HEIGHT = 800.0f;
+    const int BOID_COUNT = 2000;
+
+    std::printf("Embedded engine test - %d boids\n", BOID_COUNT);
+
+    Simulation sim(BOID_COUNT, WIDTH, HEIGHT);
+    for (int i = 0; i < 50; ++i) sim.step(Vector2D(600.0f, 400.0f));
+    check(sim.stepCount == 50, "step counter advances");
+
+    bool inside = true, finite = true;
+    for (const Boid& b : sim.boids) {
+        if (b.pos.x < 0 || b.pos.x > WIDTH || b.pos.y < 0 || b.pos.y > HEIGHT) inside = false;
+        if (!std::isfinite(b.vel.x) || !std::isfinite(b.vel.y)) finite = false;
+    }
+    check(inside, "boids stay inside the wrapped world");
+    check(finite, "velocities are finite");
+
+    // Spatial index: every boid is returned by a query at its own position
+    sim.buildGrid();
+    Boid* found[4096];
+    int missing = 0;
+    for (int i = 0; i < BOID_COUNT; i += 97) {
+        Boid* self = &sim.boids[i];
+        int n = sim.grid.query(self->pos.x, self->pos.y, found, 4096);
+        bool hit = false;
+        for (int k = 0; k < n; ++k) hit = hit || found[k] == self;
+        if (!hit) ++missing;
+    }
+    check(missing == 0, "grid query finds each boid");
+
+    float rows[] = { 10.0f, 10.0f, 1.0f, 0.0f };
+    sim.add_boids(rows, 1, 4);
+    sim.remove_boids(std::vector<int>(1, 0));
+    check(sim.tombstones.aliveCount() == BOID_COUNT, "add/remove keep the alive count");
+
+    sim.set_param(PARAM_MAX_SPEED, 4.0f);
+    sim.add_boids(rows, 1, 4);
+    check(sim.boids.back().maxSpeed == 4.0f, "added boids take the current max_speed");
+
+    // A thread override above the OpenMP maximum must not outgrow the
+    // per-thread attractor and alarm scratch (ctest also runs this with
+    // OMP_NUM_THREADS=1)
+    {
+        Simulation t(BOID_COUNT, WIDTH, HEIGHT);
+        float patch[5] = { 600.0f, 400.0f, 300.0f, 1.0f, 1e6f };
+        t.set_attractors(patch, 1);
+        check(!t.set_alarm_field(0, 40) && !t.set_alarm_field(60, -1) && !t.alarm.active(),
+              "alarm field rejects non-positive sizes");
+        t.set_alarm_field(60, 40);
+        t.tuner.setOverride(omp_get_max_threads() + 3);
+        for (int i = 0; i < 20; ++i) t.step(Vector2D(600.0f, 400.0f));
+        check(t.tuner.getOverride() <= omp_get_max_threads(), "thread override is clamped");
+        check(t.tuner.lastThreads(PHASE_FLOCK) <= omp_get_max_threads(), "flock team within the maximum");
+    }
+
+    // Rewind refuses budgets below one keyframe; a budget that only fits
+    // about one keyframe group still restarts on a keyframe after eviction
+    {
+        Simulation r(BOID_COUNT, WIDTH, HEIGHT);
+        size_t key = RewindBuffer::keyframeBytes(BOID_COUNT, sizeof(Boid));
+        check(!r.enable_rewind(key - 1, 60) && !r.history.active(), "rewind rejects a budget below one keyframe");
+        check(r.enable_rewind(key + key / 5, 60), "rewind accepts a one-keyframe budget");
+        for (int i = 0; i < 40; ++i) r.step(Vector2D(600.0f, 400.0f));
+        r.history.flush();
+        int back = static_cast<int>(r.stepCount - r.history.oldestStep());
+        check(r.history.frameCount() > 0 && r.rewind(back) == back, "tight rewind budget keeps a restorable keyframe");
+    }
+
+    // Graph queries don't compact: hops come back in the caller's indices
+    {
+        Simulation g(BOID_COUNT, WIDTH, HEIGHT);
+        g.compactThreshold = 1.0f;
+        g.remove_boids(std::vector<int>(1, 0));
+        std::vector<int32_t> hops(BOID_COUNT);
+        std::vector<int> seeds(1, 10);
+        seeds.push_back(0);
+        std::vector<int64_t> sizes;
+        bool ran = g.wavefront(BOID_COUNT, seeds, -1, 50.0f, false, hops.data(), sizes);
+        check(ran && g.boids.size() == (size_t)BOID_COUNT && hops[10] == 0 && hops[0] == -1 && sizes[0] == 1,
+              "wavefront keeps row indices");
+        check(!g.wavefront(BOID_COUNT - 1, seeds, -1, 50.0f, false, hops.data(), sizes) &&
+                  g.neighbor_graph(BOID_COUNT + 1, nullptr, nullptr, nullptr, 0, 50.0f, false) == -1,
+              "queries refuse a stale row count");
+    }
+
+    // Snapshots carry the tombstone bitmap, so max_speed no longer decides
+    // which boids are dead
+    {
+        Simulation d(BOID_COUNT, WIDTH, HEIGHT);
+        d.compactThreshold = 1.0f;
+        d.enable_rewind((size_t)64 << 20, 10);
+        d.remove_boids(std::vector<int>(1, 3));
+        d.step(Vector2D(600.0f, 400.0f));
+        d.boids[5].maxSpeed = -1.0f;
+        d.set_param(PARAM_MAX_SPEED, 3.0f);
+        d.step(Vector2D(600.0f, 400.0f));
+        d.history.flush();
+        check(d.rewind(1) == 1 && d.tombstones.isDead(3) && !d.tombstones.isDead(5) &&
+                  d.tombstones.aliveCount() == BOID_COUNT - 1,
+              "rewind restores the tombstones");
+    }
+
+    // Spawning while paging streams paged-out regions straight to disk; a
+    // region whose file is gone is kept paged out rather than lost
+    {
+        char dir[] = "/tmp/boid_pages_XXXXXX";
+        if (mkdtemp(dir)) {
+            Simulation w(0, 20000.0f, 20000.0f);
+            w.predator = Vector2D(1000.0f, 1000.0f);
+            check(w.enable_paging(dir, 2000.0f, 1500.0f, 30), "paging starts on an empty world");
+            SpawnSpec uniform;
+            uniform.layout = SPAWN_UNIFORM;
+            w.spawn(uniform, 100000);
+            check(w.boids.size() < 10000 && w.boids.size() + w.pager.pagedCount() == 100000,
+                  "spawn writes paged-out regions to disk");
+            int far = w.pager.regionOf(Vector2D(19000.0f, 19000.0f));
+            std::remove((std::string(dir) + "/region_" + std::to_string(far) + ".bin").c_str());
+            check(!w.disable_paging() && w.pager.active() && !w.pager.isResident(far) && w.pager.readFailures() == 1,
+                  "unreadable region stays paged out");
+            w.disable_paging();
+            w.pager.stop();
+            std::remove(dir);
+        } else {
+            check(false, "temporary page directory");
+        }
+    }
+
+    // A world far larger than its boids gets a sparse grid: buckets only
+    // for occupied cells, and queries still find every boid. Paging starts
+    // with the regions around every predator resident.
+    {
+        Simulation big(0, 200000.0f, 200000.0f);
+        float rows4[] = { 10.0f, 10.0f, 1.0f, 0.0f, 150000.0f, 90000.0f, 0.0f, 1.0f, 199990.0f, 5.0f, 1.0f, 1.0f };
+        big.add_boids(rows4, 3, 4);
+        big.buildGrid();
+        Boid* near[16];
+        bool all = true;
+        for (Boid& b : big.boids) {
+            int k = big.grid.query(b.pos.x, b.pos.y, near, 16);
+            all = all && std::find(near, near + k, &b) != near + k;
+        }
+        check(big.grid.isSparse() && big.grid.bucketCount() <= 3 && all, "sparse grid covers a huge world");
+        // boids 0 and 2 are neighbours across the wrap
+        check(big.grid.query(10.0f, 10.0f, near, 16) == 2, "sparse grid wraps at the edges");
+
+        char dir[] = "/tmp/boid_pages_XXXXXX";
+        if (mkdtemp(dir)) {
+            Simulation w(0, 20000.0f, 20000.0f);
+            w.predator = Vector2D(1000.0f, 1000.0f);
+            w.extraPredators.push_back(Vector2D(15000.0f, 15000.0f));
+            float second[] = { 15000.0f, 15000.0f, 1.0f, 0.0f };
+            w.add_boids(second, 1, 4);
+            bool ok = w.enable_paging(dir, 2000.0f, 1500.0f, 30);
+            check(ok && w.pager.isResident(w.pager.regionOf(Vector2D(15000.0f, 15000.0f))) && w.boids.size() == 1,
+                  "paging keeps regions around extra predators");
+            w.disable_paging();
+            w.pager.stop();
+            std::remove(dir);
+        }
+    }
+
+    // Opening a segment name that already exists replaces it rather than
+    // rewriting it: an attached reader keeps the old, complete header and a
+    // new reader sees the new one
+    {
+        const char* seg = "/boid_engine_test_embed";
+        SharedStatePublisher stale, pub;
+        SharedStateReader before, after;
+        bool ok = stale.open(seg, 100, WIDTH, HEIGHT) && before.open(seg);
+        ok = ok && pub.open(seg, 200, 2 * WIDTH, HEIGHT) && after.open(seg);
+        check(ok && before.width() == WIDTH && after.width() == 2 * WIDTH, "reopened segment is a fresh object");
+
+        // Tokens naming a slot outside the segment are never valid, and a
+        // reader with live views keeps its mapping
+        Simulation src(100, WIDTH, HEIGHT);
+        src.enable_shared_publisher(seg, 0);
+        src.step(Vector2D(600.0f, 400.0f));
+        SharedStateReader r;
+        SharedStateReader::Frame f;
+        bool got = r.open(seg) && r.latest(f) && r.isValid(f);
+        f.slot = 1u << 30;
+        check(got && !r.isValid(f), "forged shared-state token is rejected");
+        r.views = 1;
+        bool kept = !r.close() && r.isOpen();
+        r.views = 0;
+        check(kept && r.close() && !r.isOpen() && !r.latest(f), "reader keeps its mapping while views are alive");
+    }
+
+    // Seeded layouts: same seed, same boids; Poisson keeps its spacing
+    SpawnSpec spec;
+    spec.seed = 7;
+    spec.minDistance = 12.0f;
+    Simulation p1(BOID_COUNT, WIDTH, HEIGHT, spec), p2(BOID_COUNT, WIDTH, HEIGHT, spec);
+    bool same = p1.boids.size() == p2.boids.size();
+    for (size_t i = 0; same && i < p1.boids.size(); ++i)
+        same = p1.boids[i].pos.x == p2.boids[i].pos.x && p1.boids[i].vel.y == p2.boids[i].vel.y;
+    check(same, "spawn is reproducible for a seed");
+
+    float closest = 1e9f;
+    for (int i = 0; i < BOID_COUNT; ++i) {
+        for (int j = i + 1; j < BOID_COUNT; ++j)
+            closest = std::min(closest, p1.boids[i].wrappedDiff(p1.boids[i].pos, p1.boids[j].pos).mag());
+    }
+    check(closest >= spec.minDistance * 0.999f, "Poisson layout keeps min_distance");
+
+    // A tiny min_distance is raised to a floor instead of sizing the
+    // background grid by 1 / r^2
+    std::vector<Vector2D> tiny;
+    poissonPositions(BOID_COUNT, WIDTH, HEIGHT, 0.001f, 7, tiny);
+    check(tiny.size() == (size_t)BOID_COUNT, "tiny min_distance is clamped");
+
+    spec.layout = SPAWN_MILL;
+    Simulation mill(BOID_COUNT, WIDTH, HEIGHT, spec);
+    float turning = 0.0f;
+    for (const Boid& b : mill.boids) {
+        Vector2D r = b.pos - Vector2D(WIDTH / 2, HEIGHT / 2);
+        turning += (r.x * b.vel.y - r.y * b.vel.x) > 0 ? 1.0f : 0.0f;
+    }
+    check(turning > 0.95f * BOID_COUNT, "mill boids circle the center");
+
+    // Out-of-range scenario values fail with file:line
+    const char* badScenarios[] = { "[world]\nthreads = 100000\n", "[obstacle]\nradius = -3\n",
+                                   "[attractor]\ncapacity = 0\n", "[params]\nalarm_field = 0 10\n",
+                                   "[population]\nschools = -3\n", "[population]\nouter_radius = -1\n",
+                                   "[predator]\nradius = -50\n", "[predator]\nperiod = 0\n" };
+    int rejected = 0;
+    for (const char* text : badScenarios) {
+        std::istringstream in(text);
+        try {
+            parseScenario(in, "bad.ini");
+        } catch (const std::runtime_error& e) {
+            if (std::string(e.what()).compare(0, 8, "bad.ini:") == 0) ++rejected;
+        }
+    }
+    check(rejected == 8, "scenario rejects out-of-range values");
+
+    // Flow field: exact at nodes, bilinear between them, wrapped any
+    // distance outside the world, and pushed frames only show after a swap
+    {
+        float field[2 * 4 * 2];
+        for (int j = 0; j < 2; ++j) {
+            for (int i = 0; i < 4; ++i) {
+                field[(j * 4 + i) * 2] = static_cast<float>(i);
+                field[(j * 4 + i) * 2 + 1] = 10.0f * j;
+            }
+        }
+        FlowField f;
+        f.load(field, 4, 2, 400.0f, 200.0f);
+        auto near = [](Vector2D v, float x, float y) { return std::fabs(v.x - x) < 1e-4f && std::fabs(v.y - y) < 1e-4f; };
+        check(near(f.sample(150.0f, 50.0f), 1.0f, 0.0f) && near(f.sample(100.0f, 100.0f), 0.5f, 5.0f),
+              "flow samples nodes and interpolates");
+        check(near(f.sample(0.0f, 50.0f), 1.5f, 0.0f) && near(f.sample(150.0f + 400.0f * 7, 50.0f - 200.0f * 9), 1.0f, 0.0f),
+              "flow wraps far-outside positions");
+        std::vector<float> next(field, field + 16);
+        for (float& v : next) v += 100.0f;
+        bool pushed = f.pushFrame(next.data()) && !f.pushFrame(field);
+        bool unchanged = near(f.sample(150.0f, 50.0f), 1.0f, 0.0f);
+        f.swapIfPending();
+        check(pushed && unchanged && near(f.sample(150.0f, 50.0f), 101.0f, 100.0f), "flow frame shows after the swap");
+    }
+
+    // Attractors: each step removes what the feeding boids ate, never
+    // below zero, and a depleted patch no longer pulls
+    {
+        float patch[5] = { 100.0f, 100.0f, 50.0f, 1.0f, 1.0f };
+        AttractorSet a;
+        a.set(patch, 1, 400.0f, 400.0f);
+        Boid inside(110.0f, 100.0f), outside(300.0f, 300.0f);
+        Vector2D target;
+        bool pulls = a.best(inside, target) == 0 && a.best(outside, target) == -1;
+        a.beginStep(2);
+        a.threadSlots(0)[0] = 0.25f;
+        a.threadSlots(1)[0] = 0.5f;
+        a.endStep();
+        bool partial = std::fabs(a[0].capacity - 0.25f) < 1e-6f && a.best(inside, target) == 0;
+        a.beginStep(1);
+        a.threadSlots(0)[0] = 0.75f;
+        a.endStep();
+        check(pulls && partial && a[0].capacity == 0.0f, "attractor consumption respects capacity");
+        check(a.best(inside, target) == -1, "depleted attractor stops pulling");
+
+        Simulation s(500, 400.0f, 400.0f);
+        float big[5] = { 200.0f, 200.0f, 150.0f, 1.0f, 3.0f };
+        s.set_attractors(big, 1);
+        s.set_param(PARAM_CONSUME_RATE, 0.01f);
+        float before = s.attractors[0].capacity;
+        s.step(Vector2D(-1000.0f, -1000.0f));
+        float ate = before - s.attractors[0].capacity;
+        for (int i = 0; i < 20; ++i) s.step(Vector2D(-1000.0f, -1000.0f));
+        check(ate > 0.0f && ate <= 500 * 0.01f + 1e-4f && s.attractors[0].capacity == 0.0f,
+              "stepping drains an attractor to exactly zero");
+    }
+
+    // Trails: positions quantise to within half a quantum (clamped to the
+    // world), the ring keeps the newest `length` steps in order, and every
+    // reallocation bumps the generation
+    {
+        TrailBuffer t;
+        t.resize(3, 2, 100.0f, 50.0f);
+        for (int s = 1; s <= 4; ++s) {
+            t.record(0, Vector2D(10.0f * s, 5.0f * s));
+            t.record(1, Vector2D(-5.0f, 1000.0f));
+            t.advance();
+        }
+        const uint16_t* xs = t.xData();
+        const uint16_t* ys = t.yData();
+        int latest = t.latestSlot(), prev = (latest + 2) % 3, oldest = (latest + 1) % 3;
+        check(std::fabs(xs[latest * 2] * t.scaleX() - 40.0f) <= 0.5f * t.scaleX() &&
+                  std::fabs(ys[latest * 2] * t.scaleY() - 20.0f) <= 0.5f * t.scaleY() && xs[latest * 2 + 1] == 0 &&
+                  ys[latest * 2 + 1] == 65535,
+              "trails quantise and clamp positions");
+        check(t.filledSlots() == 3 && std::fabs(xs[prev * 2] * t.scaleX() - 30.0f) < 0.01f &&
+                  std::fabs(xs[oldest * 2] * t.scaleX() - 20.0f) < 0.01f,
+              "trail ring keeps the newest steps in order");
+        uint64_t g0 = t.generation();
+        t.extend(std::vector<Vector2D>(1, Vector2D(60.0f, 25.0f)));
+        uint64_t g1 = t.generation();
+        std::vector<char> keep(3, 1);
+        keep[1] = 0;
+        t.compact(keep);
+        check(g1 != g0 && t.generation() != g1 && t.numBoids() == 2 &&
+                  std::fabs(t.xData()[t.latestSlot() * 2] * t.scaleX() - 40.0f) < 0.01f &&
+                  std::fabs(t.xData()[t.latestSlot() * 2 + 1] * t.scaleX() - 60.0f) < 0.01f,
+              "trail extend and compact bump the generation");
+    }
+
+    // Stream server addresses: malformed ports and non-socket unix paths
+    // are rejected, and the file at such a path is left alone
+    {
+        StreamServer srv;
+        bool rejected = !srv.start("tcp:abc", WIDTH, HEIGHT) && !srv.start("tcp:", WIDTH, HEIGHT) &&
+                        !srv.start("tcp:0", WIDTH, HEIGHT) && !srv.start("tcp:70000", WIDTH, HEIGHT) &&
+                        !srv.start("tcp:80x", WIDTH, HEIGHT);
+        check(rejected, "stream server rejects bad ports");
+        char path[] = "/tmp/boid_not_a_socket_XXXXXX";
+        int fd = mkstemp(path);
+        bool kept = fd >= 0 && !srv.start(std::string("unix:") + path, WIDTH, HEIGHT) && access(path, F_OK) == 0;
+        check(kept, "stream server leaves a regular file alone");
+        if (fd >= 0) {
+            close(fd);
+            std::remove(path);
+        }
+    }
+
+    // Stream server over a loopback unix socket: subscribe, then decode a
+    // keyframe and a delta against the engine's own positions. A client
+    // that stops reading misses frames, and the deltas it does get stay
+    // relative to the last frame it was sent.
+    {
+        char dir[] = "/tmp/boid_stream_XXXXXX";
+        if (mkdtemp(dir)) {
+            const std::string path = std::string(dir) + "/frames.sock";
+            Simulation s(20000, WIDTH, HEIGHT);
+            int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un sa;
+            std::memset(&sa, 0, sizeof(sa));
+            sa.sun_family = AF_UNIX;
+            std::strcpy(sa.sun_path, path.c_str());
+            uint8_t sub[24] = { 'S' };
+            uint32_t every = 1;
+            std::memcpy(sub + 4, &every, 4);
+            bool up = s.start_stream_server("unix:" + path) && fd >= 0 &&
+                      connect(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) == 0 && send(fd, sub, 24, 0) == 24;
+            for (int i = 0; i < 1000 && up && s.streamer.subscriberCount() == 0; ++i) usleep(1000);
+            check(up && s.streamer.subscriberCount() == 1, "stream client subscribes");
+
+            std::vector<uint16_t> q;
+            StreamFrame f;
+            bool key = false;
+            for (int tries = 0; tries < 10 && !key; ++tries) {
+                s.step(Vector2D(600.0f, 400.0f));
+                key = readFrame(fd, f, 500);
+            }
+            key = key && f.kind == 0 && f.step == s.stepCount && applyFrame(f, q) && q == quantised(s);
+            check(key, "stream keyframe decodes to the positions");
+            s.step(Vector2D(600.0f, 400.0f));
+            bool delta = readFrame(fd, f, 2000) && f.kind == 1 && f.step == s.stepCount && applyFrame(f, q) &&
+                         q == quantised(s);
+            check(delta, "stream delta decodes to the positions");
+
+            const int burst = 30;
+            for (int i = 0; i < burst; ++i) s.step(Vector2D(600.0f, 400.0f));
+            int received = 0;
+            uint64_t lastStep = s.stepCount - burst;
+            bool ordered = true;
+            while (readFrame(fd, f, 300)) {
+                ordered = ordered && f.step > lastStep && applyFrame(f, q);
+                lastStep = f.step;
+                ++received;
+            }
+            s.step(Vector2D(600.0f, 400.0f));
+            bool caughtUp = readFrame(fd, f, 2000) && f.step == s.stepCount && applyFrame(f, q) && q == quantised(s);
+            check(received < burst && ordered && caughtUp, "slow stream client drops frames, catches up");
+
+            if (fd >= 0) close(fd);
+            s.stop_stream_server();
+            std::remove(dir);
+        } else {
+            check(false, "temporary stream directory");
+        }
+    }
+
+    // Arrow export: a struct array of five nullable columns whose children
+    // share one validity buffer, with the removed row null in each; every
+    // struct can be released, children moved out first included
+    {
+        Simulation a(100, WIDTH, HEIGHT);
+        a.compactThreshold = 1.0f;
+        a.remove_boids(std::vector<int>(1, 9));
+        ArrowSchema schema;
+        ArrowArray array;
+        exportBoidSchema(&schema);
+        exportBoidArray(a.boids, a.tombstones, &array, 2);
+        const char* formats[] = { "i", "f", "f", "f", "f" };
+        bool layout = std::strcmp(schema.format, "+s") == 0 && schema.n_children == 5 && array.n_children == 5 &&
+                      array.length == 100 && array.null_count == 0 && array.n_buffers == 1;
+        for (int k = 0; k < 5 && layout; ++k) {
+            const ArrowArray* c = array.children[k];
+            layout = std::strcmp(schema.children[k]->format, formats[k]) == 0 &&
+                     std::strcmp(schema.children[k]->name, ARROW_BOID_NAMES[k]) == 0 &&
+                     (schema.children[k]->flags & ARROW_FLAG_NULLABLE) && c->length == 100 && c->null_count == 1 &&
+                     c->n_buffers == 2 && c->buffers[0] == array.children[0]->buffers[0];
+        }
+        check(layout, "arrow export declares the five columns");
+        const uint8_t* valid = static_cast<const uint8_t*>(array.children[0]->buffers[0]);
+        const int32_t* ids = static_cast<const int32_t*>(array.children[0]->buffers[1]);
+        const float* xs = static_cast<const float*>(array.children[1]->buffers[1]);
+        const float* vys = static_cast<const float*>(array.children[4]->buffers[1]);
+        check(!(valid[1] & (1 << 1)) && (valid[1] & (1 << 2)) && (valid[0] & 1) && ids[42] == 42 &&
+                  xs[42] == a.boids[42].pos.x && vys[99] == a.boids[99].vel.y,
+              "arrow columns hold the boids, removed row null");
+
+        ArrowArray moved = *array.children[3]; // a consumer taking one child
+        array.children[3]->release = nullptr;
+        array.release(&array);
+        bool childAlive = static_cast<const float*>(moved.buffers[1])[5] == a.boids[5].vel.x;
+        moved.release(&moved);
+        schema.release(&schema);
+        check(array.release == nullptr && moved.release == nullptr && schema.release == nullptr && childAlive,
+              "arrow structs release, moved child survives");
+
+        ArrowArrayStream stream;
+        exportBoidStream(a.boids, a.tombstones, &stream);
+        ArrowArray batch, end;
+        bool streamed = stream.get_schema(&stream, &schema) == 0 && stream.get_next(&stream, &batch) == 0 &&
+                        batch.length == 100 && stream.get_next(&stream, &end) == 0 && end.release == nullptr;
+        batch.release(&batch);
+        schema.release(&schema);
+        stream.release(&stream);
+        check(streamed && stream.release == nullptr, "arrow stream yields one batch then ends");
+    }
+
+    // Vector2DArray: element-wise arithmetic matches Vector2D exactly, the
+    // floats are packed (x, y) pairs, and an array of predators is fled
+    // from beyond the first
+    {
+        const float xy[] = { 1.0f, 2.5f, 0.1f, 0.7f, 3.3f, -9.9f, 1e-3f, 123.456f }; // 2.5 / 3 != 2.5 * (1 / 3)
+        Vector2DArray v(xy, 4);
+        const Vector2D shift(0.5f, -1.5f);
+        Vector2DArray sum = v + v, diff = v - shift, scaled = v * 0.3f, divided = v / 3.0f;
+        bool exact = v.size() == 4 && v.floats()[5] == -9.9f;
+        for (size_t i = 0; i < v.size(); ++i) {
+            const Vector2D& p = v.items[i];
+            Vector2D q = p / 3.0f;
+            exact = exact && sum.items[i].x == (p + p).x && diff.items[i].y == (p - shift).y &&
+                    scaled.items[i].x == (p * 0.3f).x && divided.items[i].x == q.x && divided.items[i].y == q.y;
+        }
+        check(exact, "Vector2DArray arithmetic matches Vector2D");
+        Vector2DArray unit = v.normalized(), capped = v.limited(1.0f);
+        std::vector<float> mags = v.mag();
+        check(std::fabs(unit.mag()[2] - 1.0f) < 1e-6f && capped.mag()[3] <= 1.0f + 1e-6f &&
+                  capped.items[0].x == v.limited(1.0f).items[0].x && mags[0] == v.items[0].mag(),
+              "Vector2DArray normalize, limit and mag");
+
+        Simulation m(0, WIDTH, HEIGHT);
+        float still[] = { 500.0f, 500.0f, 0.0f, 0.0f };
+        m.add_boids(still, 1, 4);
+        Vector2DArray predators;
+        predators.items.push_back(Vector2D(-1000.0f, -1000.0f));
+        predators.items.push_back(Vector2D(530.0f, 500.0f));
+        for (int i = 0; i < 5; ++i) m.step(predators);
+        check(m.boids[0].pos.x < 500.0f && m.boids[0].vel.x < 0.0f, "boids flee the second predator of an array");
+    }
+
+    // A stop requested before run_realtime starts ends it at once and is
+    // cleared on the way out, so the next run goes ahead
+    {
+        Simulation rt(50, 200.0f, 200.0f);
+        rt.stop_realtime();
+        check(rt.run_realtime(1000.0, 1, nullptr, 5) == 0, "early stop_realtime ends the run");
+        check(rt.run_realtime(1000.0, 1, nullptr, 5) == 5, "stop request is cleared after the run");
+    }
+
+    std::printf("%s\n", failures == 0 ? "PASSED" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+"""
+Check the CSR neighbor graph export against a brute-force NumPy search
+and measure how long the export takes.
+"""
+import time
+import sys
+import numpy as np
+
+
+def brute_force_edges(pos, width, height, radius):
+    """O(n^2) reference: number of wrapped neighbors within radius per boid"""
+    diff = pos[:, None, :] - pos[None, :, :]
+    diff[..., 0] = (diff[..., 0] + width / 2) % width - width / 2
+    diff[..., 1] = (diff[..., 1] + height / 2) % height - height / 2
+    d_sq = (diff ** 2).sum(axis=2)
+    np.fill_diagonal(d_sq, np.inf)
+    return (d_sq < radius * radius).sum(axis=1)
+
+
+def test_neighbor_graph_matches_brute_force():
+    import boid_engine
+
+    WIDTH, HEIGHT = 1200, 800
+    BOID_COUNT = 2000
+    RADIUS = 50.0
+
+    print(f"\n{'='*60}")
+    print(f"Neighbor Graph Test - {BOID_COUNT} boids")
+    print(f"{'='*60}\n")
+
+    sim = boid_engine.Simulation(BOID_COUNT, float(WIDTH), float(HEIGHT))
+    predator_pos = boid_engine.Vector2D(-1000.0, -1000.0)
+    for _ in range(20):
+        sim.step(predator_pos)
+
+    indptr = np.zeros(BOID_COUNT + 1, dtype=np.int64)
+    indices = np.zeros(1, dtype=np.int32)
+
+    # First call sizes the buffers, second fills them
+    nnz = sim.neighbor_graph(indptr, indices, radius=RADIUS)
+    indices = np.zeros(nnz, dtype=np.int32)
+    distances = np.zeros(nnz, dtype=np.float32)
+    sim.neighbor_graph(indptr, indices, distances, radius=RADIUS)
+
+    pos = sim.get_full_state()[:, :2].astype(np.float64)
+    expected = brute_force_edges(pos, WIDTH, HEIGHT, RADIUS)
+    degrees = np.diff(indptr)
+
+    # Allow a handful of float32-vs-float64 disagreements right at the radius
+    mismatches = int(np.abs(degrees - expected).sum())
+    ok = mismatches <= max(2, nnz // 1000) and bool(np.all(distances < RADIUS))
+    print(f"  Edges: {nnz} (average degree {nnz / BOID_COUNT:.1f})")
+    print(f"  {'✓' if ok else '✗'} Degrees match brute force")
+
+    start = time.perf_counter()
+    for _ in range(20):
+        sim.neighbor_graph(indptr, indices, distances, radius=RADIUS)
+    elapsed = (time.perf_counter() - start) / 20 * 1000
+    print(f"  Export time: {elapsed:.2f} ms")
+
+    return ok
+
+
+if __name__ == "__main__":
+    try:
+        import boid_engine
+    except ImportError:
+        print("ERROR: boid_engine module not found!")
+        print("Please build the module first with: pip install .")
+        sys.exit(1)
+
+    ok = test_neighbor_graph_matches_brute_force()
+    sys.exit(0 if ok else 1)